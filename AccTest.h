@@ -23,18 +23,221 @@
 #ifndef __ACC_TEST_H__
 #define __ACC_TEST_H__
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <functional>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
+#include <limits>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <random>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
 #include <vector>
 
+// Running scenarios in worker processes needs fork() and pipes, and loading suites from shared libraries needs dlopen(). 
+// Define ACC_TEST_NO_POSIX to leave this out on platforms that look like POSIX but lack them.
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(ACC_TEST_NO_POSIX)
+#define ACC_TEST_POSIX 1
+#include <cerrno>
+#include <csignal>
+#include <dlfcn.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 namespace ProTest {
 
     template <class T> class AccTestStep;
     template <class T> class AccTestScenario;
 
+    // The clock used to time scenarios and steps, and the time spent in each of their phases. Start is the point in time the 
+    // first phase began; the durations of the phases that didn't run are zero. The Steps phase of a scenario covers everything
+    // from the end of its Setup to the beginning of its Teardown.
+
+    typedef std::chrono::steady_clock AccTestClock;
+
+    struct AccTestStepTiming {
+        AccTestClock::time_point Start;
+        AccTestClock::duration Setup = AccTestClock::duration::zero();
+        AccTestClock::duration Expect = AccTestClock::duration::zero();
+        AccTestClock::duration Act = AccTestClock::duration::zero();
+        AccTestClock::duration Verify = AccTestClock::duration::zero();
+        AccTestClock::duration Teardown = AccTestClock::duration::zero();
+
+        AccTestClock::duration GetTotal() const {
+            return Setup + Expect + Act + Verify + Teardown;
+        }
+    };
+
+    struct AccTestScenarioTiming {
+        AccTestClock::time_point Start;
+        AccTestClock::duration Setup = AccTestClock::duration::zero();
+        AccTestClock::duration Steps = AccTestClock::duration::zero();
+        AccTestClock::duration Teardown = AccTestClock::duration::zero();
+
+        AccTestClock::duration GetTotal() const {
+            return Setup + Steps + Teardown;
+        }
+    };
+
+    // The statistics of the measured iterations of a benchmark step (see AccTestBenchmarkStep). The percentiles are of the 
+    // nearest-rank kind, so each of them is the duration of one of the iterations; StdDev is the sample standard deviation.
+
+    struct AccTestBenchmarkResult {
+        std::size_t WarmupIterations = 0;
+        std::size_t Iterations = 0;
+        AccTestClock::duration Min = AccTestClock::duration::zero();
+        AccTestClock::duration Median = AccTestClock::duration::zero();
+        AccTestClock::duration Mean = AccTestClock::duration::zero();
+        AccTestClock::duration P90 = AccTestClock::duration::zero();
+        AccTestClock::duration P99 = AccTestClock::duration::zero();
+        AccTestClock::duration Max = AccTestClock::duration::zero();
+        AccTestClock::duration StdDev = AccTestClock::duration::zero();
+
+        static AccTestBenchmarkResult FromSamples(std::vector<AccTestClock::duration> samples, std::size_t warmupIterations) {
+            AccTestBenchmarkResult result;
+            result.WarmupIterations = warmupIterations;
+            result.Iterations = samples.size();
+            if (samples.empty())
+                return result;
+            std::sort(samples.begin(), samples.end());
+            auto percentile = [&samples](double fraction) {
+                auto rank = static_cast<std::size_t> (std::ceil(fraction * samples.size()));
+                return samples[rank > 0 ? rank - 1 : 0];
+            };
+            result.Min = samples.front();
+            result.Median = percentile(0.5);
+            result.P90 = percentile(0.9);
+            result.P99 = percentile(0.99);
+            result.Max = samples.back();
+            double sum = 0;
+            for (auto sample : samples)
+                sum += sample.count();
+            auto mean = sum / samples.size();
+            double squaredDeviations = 0;
+            for (auto sample : samples)
+                squaredDeviations += (sample.count() - mean) * (sample.count() - mean);
+            auto stdDev = samples.size() > 1 ? std::sqrt(squaredDeviations / (samples.size() - 1)) : 0.0;
+            result.Mean = AccTestClock::duration(static_cast<AccTestClock::rep> (mean + 0.5));
+            result.StdDev = AccTestClock::duration(static_cast<AccTestClock::rep> (stdDev + 0.5));
+            return result;
+        }
+    };
+
+    // Where a check is made in the source code. The checking macros fill it in with string literals, so a site costs no more 
+    // than three words and the texts are shared by every check made at the same place. Sites of checks made by calling 
+    // AccTestStep::Check directly are empty. Texts that don't come from literals, e.g. those of sites received from another 
+    // process, are interned so that they last as long as the program and are stored only once.
+
+    struct AccTestCheckSite {
+        const char* File;
+        int Line;
+        const char* Expression;
+
+        static const char* Intern(const std::string& text) {
+            static std::mutex mutex;
+            static std::set<std::string> texts;
+            std::lock_guard<std::mutex> lock(mutex);
+            return texts.insert(text).first->c_str();
+        }
+    };
+
+    // A failed check of a step: its number among all the checks of the step (counting from 1), where it was made, and where its
+    // output starts in the output shared by all the failed checks of the step.
+
+    struct AccTestCheckRecord {
+        int CheckIndex;
+        AccTestCheckSite Site;
+        std::size_t OutputStart;
+    };
+
+    // A view of the failed checks of a step, handed to the observers through StepChecksFailed. It refers to the records and the
+    // output kept by the step without copying them, so it is only valid during the call. The output of each check runs up to
+    // where the output of the next one starts.
+
+    class AccTestCheckRecords {
+    public:
+        typedef std::vector<AccTestCheckRecord>::const_iterator Iterator;
+
+        AccTestCheckRecords(const std::vector<AccTestCheckRecord>& records, const std::string& output)
+        : m_Records(records), m_Output(output) {
+        }
+
+        std::size_t GetSize() const {
+            return m_Records.size();
+        }
+
+        const AccTestCheckRecord& operator[](std::size_t index) const {
+            return m_Records[index];
+        }
+
+        Iterator begin() const {
+            return m_Records.begin();
+        }
+
+        Iterator end() const {
+            return m_Records.end();
+        }
+
+        const char* GetOutputData(std::size_t index) const {
+            return m_Output.data() + m_Records[index].OutputStart;
+        }
+
+        std::size_t GetOutputLength(std::size_t index) const {
+            auto end = index + 1 < m_Records.size() ? m_Records[index + 1].OutputStart : m_Output.size();
+            return end - m_Records[index].OutputStart;
+        }
+
+        std::string GetOutput(std::size_t index) const {
+            return std::string(GetOutputData(index), GetOutputLength(index));
+        }
+
+        const std::vector<AccTestCheckRecord>& GetRecords() const {
+            return m_Records;
+        }
+
+        const std::string& GetOutput() const {
+            return m_Output;
+        }
+
+        std::map<int, std::string> ToMap() const {
+            std::map<int, std::string> outputs;
+            for (std::size_t index = 0; index < m_Records.size(); ++index)
+                outputs[m_Records[index].CheckIndex] = GetOutput(index);
+            return outputs;
+        }
+
+    private:
+        const std::vector<AccTestCheckRecord>& m_Records;
+        const std::string& m_Output;
+    };
+
     // The abstract interface for observing status and progress of the test execution through scenarios and steps. During 
     // execution of the test suite, an instance of this class is passed to the test suite and each scenario and they use 
     // the instance to log test execution events.
@@ -58,488 +261,6014 @@ namespace ProTest {
         virtual void ExecutingStepTeardown() = 0;
         virtual void FinishedScenario() = 0;
         virtual void FinishedTestSuite() = 0;
-    };
 
-    // Each test step must inherit AccTestStep and override one or more of the virtual methods. Your derived constructor must 
-    // the base constructor and give it the name, description, and the flags isRequired and mustThrow. Turning isRequired on for 
-    // test step means that its success is essential for proceeding to subsequent steps. If a required test step fails, all 
-    // subsequent steps will be omitted. Turning on the mustThrow flag means that the executing the step Action must throw an 
-    // exception. If this flag is raised but the action doesn't throw, the step fails. 
-    // You will almost certainly want to override the Act() method. This is where the action happens - some 
-    // message is sent to the application, an event is raised, etc. Just make that your implementation of Act() calls SetActed() 
-    // at the end.
-    // If you are using mock objects in your test, you should override Expect() and put your expectations there. But don't forget
-    // to verify them in Verify().
-    // You will also, almost very certainly, want to override Verify() to see if the action has had the expected effect on the 
-    // context - otherwise, what's the point of testing! If you are using mock objects in your context, make sure to verify all the
-    // expectations or reset them before the context is handed over to the unsuspecting next step. Use the protected Check() 
-    // method within your Verify() implementation to check if a certain condition is met. If the condition is true the test step is 
-    // considered passed. If one of the Check invocations within the test step is given a false value, the whole step is considered
-    // failed. You can pass data to the return value from the Check() calls. This data will be sent to the output if the check 
-    // should fail.
-    // If you need somewhere to initialize the context before running the step, you will need to override Setup(). The finalizing
-    // counterpart is, of course, Teardown().
+        // Reported when the worker process running a scenario died, e.g. because of a crash inside a step, and replaces the 
+        // remaining events of the scenario except FinishedScenario. Observers not overriding it see the scenario terminated by
+        // an exception.
+        virtual void ScenarioCrashed(const std::string& /*reason*/) {
+            ExceptionInScenario();
+        }
 
-    template <typename T>
-    class AccTestStep {
-    public:
-        typedef T TestContextType;
+        // Reported right before a scenario with branches (see AccTestScenario::BeginBranch) reports each of its branches as a 
+        // scenario of its own, so the one scenario announced to StartingTestSuite turns into numberOfBranches scenarios.
+        virtual void ScenarioBranched(std::size_t /*numberOfBranches*/) {
+        }
 
-        AccTestStep(const std::string& name, const std::string& description, bool isRequired = false, bool mustThrow = false)
-        : m_Name(name), m_Description(description), m_IsRequired(isRequired), m_MustThrow(mustThrow) {
+        // Reported after the scenario setup when the scenario continues from a checkpoint instead of running its first 
+        // numberOfStepsSkipped steps; those steps all passed in the run that saved the checkpoint.
+        virtual void ResumedFromCheckpoint(std::size_t /*numberOfStepsSkipped*/) {
         }
 
-        virtual void Setup() {
+        // Reported between StartingScenario and FinishedScenario, in place of all the other events of the scenario, when the 
+        // scenario isn't run because it passed in an earlier run of the same test program (see AccTestResultCache).
+        virtual void ScenarioCached() {
         }
 
-        virtual void Expect() {
+        // Reported right before FinishedTestSuite when numberOfScenarios of the scenarios announced to StartingTestSuite were 
+        // left out of the report altogether, e.g. by AccTestAsyncObserver with AccTestBackpressurePolicy::DropEvents. Their 
+        // results are unknown.
+        virtual void ScenariosDropped(std::size_t /*numberOfScenarios*/) {
         }
 
-        virtual void Act() {
+        // Called when the events reported so far should reach their destination, e.g. by AccTestAsyncObserver after each batch
+        // of events it passes on; observers writing to a stream flush it.
+        virtual void FlushOutput() {
         }
 
-        virtual void Verify() {
-            Check(true);
+        // Reported after ExecutingStepTeardown once the step tear-down has actually run, and right before FinishedScenario.
+        virtual void StepTimed(const AccTestStepTiming& /*timing*/) {
         }
 
-        virtual void Teardown() {
+        virtual void ScenarioTimed(const AccTestScenarioTiming& /*timing*/) {
         }
 
-        void SetContext(TestContextType* context) {
-            m_Context = context;
+        // Reported between StartingStepAct and the verification of a benchmark step once all of its iterations have run.
+        virtual void StepBenchmarked(const AccTestBenchmarkResult& /*result*/) {
         }
 
-        bool Passed() {
-            return m_Passed;
+        // Reported instead of StepVerificationFailed by the scenarios, with the failed checks as structured records. Observers 
+        // not overriding it get the outputs of the checks through StepVerificationFailed.
+        virtual void StepChecksFailed(const AccTestCheckRecords& failedChecks) {
+            StepVerificationFailed(failedChecks.ToMap());
         }
 
-        bool IsVerified() {
-            return m_IsVerified;
+        virtual ~AccTestObserverIface() {
         }
+    };
 
-        bool MustThrow() {
-            return m_MustThrow;
+    // Base class for observers passed to the scenarios by their static type (see AccTestScenario::RunWith and 
+    // AccTestStaticSuite) rather than through AccTestObserverIface. None of its methods is virtual: an observer derives from 
+    // AccTestNullObserver<itself> and hides the callbacks it is interested in with methods of the same signature, which the 
+    // scenarios then call directly, so they can be inlined, and the empty ones it doesn't hide compile away. As with the 
+    // interface, StepChecksFailed and ScenarioCrashed fall back on StepVerificationFailed and ExceptionInScenario.
+
+    template <typename Derived>
+    class AccTestNullObserver {
+    public:
+        void StartingTestSuite(std::size_t /*numberOfTestScenarios*/) {
         }
 
-        bool IsRequired() {
-            return m_IsRequired;
+        void StartingScenario(const std::string& /*name*/, const std::string& /*description*/, std::size_t /*numberOfSteps*/) {
         }
 
-        std::string GetName() {
-            return m_Name;
+        void ExceptionInScenario() {
         }
 
-        std::string GetDescription() {
-            return m_Description;
+        void StartingScenarioSetup() {
         }
 
-        std::map<int, std::string> GetCheckOutputs() {
-            std::map<int, std::string> outputs;
-            for (const auto& strm : m_CheckOutputs)
-                outputs[strm.first] = strm.second.str();
-            return outputs;
+        void ScenarioTerminated() {
         }
 
-    protected:
+        void RunningScenarioTeardown() {
+        }
 
-        TestContextType* GetTestContext() {
-            return m_Context;
+        void StartingScenarioStep(const std::string& /*name*/, const std::string& /*description*/) {
         }
 
-        std::ostream& Check(bool predicate) {
-            m_Passed = m_CheckCounter > 0 ? m_Passed && predicate : predicate;
-            m_IsVerified = true;
-            m_CheckCounter++;
-            return predicate ? m_SuccessCheckOutput : m_CheckOutputs[m_CheckCounter];
+        void ExecutingStepSetup() {
         }
 
-    private:
-        bool m_IsVerified = false;
-        bool m_IsRequired = false;
-        bool m_MustThrow = false;
-        bool m_Passed = false;
-        std::string m_Name = "NOT SET";
-        std::string m_Description = "NOT SET";
-        TestContextType* m_Context = nullptr;
-        std::map<int, std::ostringstream> m_CheckOutputs;
-        std::ostringstream m_SuccessCheckOutput;
-        int m_CheckCounter = 0;
-    };
+        void RunningStepExpectations() {
+        }
 
-    // Provides a base for all scenario classes so they can be aggregated within the test suite and run polymorphically.
+        void StartingStepAct() {
+        }
 
-    class AccTestScenarioBase {
-    public:
+        void StepExceptionExpectationNotMet(bool /*didThrow*/) {
+        }
 
-        AccTestScenarioBase(const std::string& name, const std::string& description)
-        : m_Name(name), m_Description(description) {
+        void StartingStepVerification() {
         }
 
-        virtual void Run(const std::shared_ptr<AccTestObserverIface>& testObserver) = 0;
+        void FinishedStepVerification(bool /*passed*/) {
+        }
 
-        std::string GetName() {
-            return m_Name;
+        void StepVerificationFailed(const std::map<int, std::string>& /*failedCheckOutputs*/) {
         }
 
-        std::string GetDescription() {
-            return m_Description;
+        void ExecutingStepTeardown() {
         }
 
-    private:
-        std::string m_Name = "NOT SET";
-        std::string m_Description = "NOT SET";
-    };
+        void FinishedScenario() {
+        }
 
-    // A test scenario which is composed of multiple steps must inherit AccTestScenario. You should create your test steps 
-    // within the constructor of your derived class and add them in the same order as you want them to be executed. Use AddStep() 
-    // to add the next test step.
-    // The test context is created and is accessible within you derived class as GetTestContext.
-    // Override Setup and Teardown to provide code for test context initialization and finalization before and after serial 
-    // execution of the steps. This is probably where you will want to create you application object and related test stubs, etc. 
-    // Don't forget to get rid of everything in Teardown. 
-    // When the scenario is run (by a call to Run), first the Setup() method is called once, then all the test steps are executed 
-    // in the order they were added, and finally the Teardown() method is called to wrap up the test. Executing each step 
-    // involves calling its Setup, Expect, Act, Verify, and Teardown methods in the same order.
-    // After executing Run(), you can retrieve the test results using GetReport(). You can use a AccTestReportFormatter to format 
-    // the report as text and send it to an output stream.
-    // When subclassing, pass the name and description of the test scenario to the base constructor. These information will 
-    // subsequently be available using GetName and GetDescription.
+        void FinishedTestSuite() {
+        }
 
-    template <class T>
-    class AccTestScenario : public AccTestScenarioBase {
-    public:
-        typedef T TestContextType;
+        void ScenarioCrashed(const std::string& /*reason*/) {
+            static_cast<Derived*> (this)->ExceptionInScenario();
+        }
 
-        AccTestScenario(const std::string& name, const std::string& description)
-        : AccTestScenarioBase(name, description) {
+        void ScenarioBranched(std::size_t /*numberOfBranches*/) {
         }
 
-        void Run(const std::shared_ptr<AccTestObserverIface>& testObserver) override {
-            testObserver->StartingScenario(GetName(), GetDescription(), m_Steps.size());
-            try {
-                RunUnprotected(testObserver);
-            } catch (...) {
-                testObserver->ExceptionInScenario();
-            }
-            testObserver->FinishedScenario();
+        void ResumedFromCheckpoint(std::size_t /*numberOfStepsSkipped*/) {
         }
 
-    protected:
+        void ScenarioCached() {
+        }
 
-        template <class StepType, class... Args>
-        void CreateStep(Args... constructionArgs) {
-            m_Steps.push_back(std::make_shared<StepType>(constructionArgs...));
+        void ScenariosDropped(std::size_t /*numberOfScenarios*/) {
         }
 
-        TestContextType* GetTestContext() {
-            return &m_TestContext;
+        void StepTimed(const AccTestStepTiming& /*timing*/) {
         }
 
-    private:
+        void ScenarioTimed(const AccTestScenarioTiming& /*timing*/) {
+        }
 
-        class ScenarioSetup {
-        public:
+        void StepBenchmarked(const AccTestBenchmarkResult& /*result*/) {
+        }
 
-            ScenarioSetup(AccTestScenario* scenario)
-            : m_Scenario(scenario) {
-                m_Scenario->Setup();
-            }
+        void StepChecksFailed(const AccTestCheckRecords& failedChecks) {
+            static_cast<Derived*> (this)->StepVerificationFailed(failedChecks.ToMap());
+        }
+    };
 
-            ~ScenarioSetup() {
-                m_Scenario->Teardown();
-            }
+    // A compile-time list of observers, itself usable as a static observer, that reports every event to each of the observers
+    // in turn. The observers are held by reference and may be of any type with the callbacks of AccTestObserverIface, 
+    // including implementations of the interface, whose callbacks are then called directly when the class is final.
+    // E.g. AccTestObserverList<MyCounter, AccTestObserver> observers(counter, textObserver).
 
-        private:
-            AccTestScenario<TestContextType>* m_Scenario;
-        };
+    template <typename... Observers>
+    class AccTestObserverList;
 
-        class StepSetup {
-        public:
+    template <>
+    class AccTestObserverList<> : public AccTestNullObserver< AccTestObserverList<> > {
+    };
 
-            StepSetup(AccTestStep<TestContextType>* step)
-            : m_Step(step) {
-                m_Step->Setup();
-            }
+    template <typename First, typename... Rest>
+    class AccTestObserverList<First, Rest...> {
+    public:
 
-            ~StepSetup() {
-                if (!m_Step->IsVerified())
-                    m_Step->Verify();
-                m_Step->Teardown();
-            }
+        AccTestObserverList(First& first, Rest&... rest)
+        : m_First(first), m_Rest(rest...) {
+        }
 
-        private:
-            AccTestStep<TestContextType>* m_Step;
-        };
+        void StartingTestSuite(std::size_t numberOfTestScenarios) {
+            m_First.StartingTestSuite(numberOfTestScenarios);
+            m_Rest.StartingTestSuite(numberOfTestScenarios);
+        }
 
-        virtual void Setup() {
+        void StartingScenario(const std::string& name, const std::string& description, std::size_t numberOfSteps) {
+            m_First.StartingScenario(name, description, numberOfSteps);
+            m_Rest.StartingScenario(name, description, numberOfSteps);
         }
 
-        virtual void Teardown() {
+        void ExceptionInScenario() {
+            m_First.ExceptionInScenario();
+            m_Rest.ExceptionInScenario();
         }
 
-        void RunUnprotected(const std::shared_ptr<AccTestObserverIface>& testObserver) {
-            testObserver->StartingScenarioSetup();
-            ScenarioSetup scenSetup(this);
-            for (const auto& step : m_Steps) {
-                auto requiredStepFailed = !RunStepUnprotected(step, testObserver) && step->IsRequired();
-                if (requiredStepFailed) {
-                    testObserver->ScenarioTerminated();
-                    break;
-                }
-            }
-            testObserver->RunningScenarioTeardown();
+        void StartingScenarioSetup() {
+            m_First.StartingScenarioSetup();
+            m_Rest.StartingScenarioSetup();
         }
 
-        bool RunStepUnprotected(const std::shared_ptr< AccTestStep<TestContextType> >& step,
-                const std::shared_ptr<AccTestObserverIface>& testObserver) {
-            testObserver->StartingScenarioStep(step->GetName(), step->GetDescription());
-            step->SetContext(&m_TestContext);
-            testObserver->ExecutingStepSetup();
-            StepSetup stepSetup(step.get());
-            testObserver->RunningStepExpectations();
-            step->Expect();
-            testObserver->StartingStepAct();
-            bool didThrow = false;
-            try {
-                step->Act();
-            } catch (...) {
-                didThrow = true;
-            }
-            bool passedThrowReq = didThrow == step->MustThrow();
-            if (!passedThrowReq)
-                testObserver->StepExceptionExpectationNotMet(didThrow);
-            else {
-                testObserver->StartingStepVerification();
-                step->Verify();
-                testObserver->FinishedStepVerification(step->Passed());
-                if (!step->Passed())
-                    testObserver->StepVerificationFailed(step->GetCheckOutputs());
-            }
-            testObserver->ExecutingStepTeardown();
-            return step->Passed();
+        void ScenarioTerminated() {
+            m_First.ScenarioTerminated();
+            m_Rest.ScenarioTerminated();
         }
 
-        std::vector< std::shared_ptr< AccTestStep<TestContextType> > > m_Steps;
-        TestContextType m_TestContext;
-    };
+        void RunningScenarioTeardown() {
+            m_First.RunningScenarioTeardown();
+            m_Rest.RunningScenarioTeardown();
+        }
 
-    // Default implementation of the test observer that a test suite uses by default. The default observer can be replaced by
-    // a custom implementation using the other overload of the AccTestSuite class or afterwards using the SetTestObserver method.
-    // This default implementation logs all the events, progress, and stats to the output stream provided. 
-    // It has also additional methods not inherited from the interface that are used to retrieve test stats after the execution.
+        void StartingScenarioStep(const std::string& name, const std::string& description) {
+            m_First.StartingScenarioStep(name, description);
+            m_Rest.StartingScenarioStep(name, description);
+        }
 
-    class AccTestObserver : public AccTestObserverIface {
-    public:
+        void ExecutingStepSetup() {
+            m_First.ExecutingStepSetup();
+            m_Rest.ExecutingStepSetup();
+        }
 
-        AccTestObserver(std::ostream& outputStream)
-        : m_OutputStream(outputStream) {
+        void RunningStepExpectations() {
+            m_First.RunningStepExpectations();
+            m_Rest.RunningStepExpectations();
         }
 
-        void StartingTestSuite(std::size_t numberOfTestScenarios) override {
-            m_OutputStream << "Starting execution of test suite" << std::endl;
-            m_NumberOfScenarios = numberOfTestScenarios;
-            m_CurrentScenarioIndex = 0;
+        void StartingStepAct() {
+            m_First.StartingStepAct();
+            m_Rest.StartingStepAct();
         }
 
-        void StartingScenario(const std::string& name, const std::string& description, std::size_t numberOfSteps) override {
-            m_NumberOfStepsInScenario = numberOfSteps;
-            ++m_CurrentScenarioIndex;
-            m_CurrentStepIndex = 0;
-            m_OutputStream << std::endl << "  Starting execution of test scenario \"" << name << "\" - " <<
-                    m_CurrentScenarioIndex << " of " << m_NumberOfScenarios <<
-                    " (" << std::setprecision(3) << GetProgressPercentage() << "%)" << std::endl <<
-                    "    Description: " << description << std::endl << "    Total number of steps: " << numberOfSteps << std::endl;
+        void StepExceptionExpectationNotMet(bool didThrow) {
+            m_First.StepExceptionExpectationNotMet(didThrow);
+            m_Rest.StepExceptionExpectationNotMet(didThrow);
         }
 
-        void StartingScenarioSetup() override {
-            m_OutputStream << "    Starting scenario setup..." << std::endl;
+        void StartingStepVerification() {
+            m_First.StartingStepVerification();
+            m_Rest.StartingStepVerification();
         }
 
-        void ScenarioTerminated() override {
-            m_OutputStream << "    A required scenario step failed; scenario execution terminated!" << std::endl;
-            ++m_NumberOfScenariosTerminated;
+        void FinishedStepVerification(bool passed) {
+            m_First.FinishedStepVerification(passed);
+            m_Rest.FinishedStepVerification(passed);
         }
 
-        void RunningScenarioTeardown() override {
-            m_OutputStream << "    Running scenario tear-down..." << std::endl;
+        void StepVerificationFailed(const std::map<int, std::string>& failedCheckOutputs) {
+            m_First.StepVerificationFailed(failedCheckOutputs);
+            m_Rest.StepVerificationFailed(failedCheckOutputs);
         }
 
-        void StartingScenarioStep(const std::string& name, const std::string& description) override {
-            ++m_CurrentStepIndex;
-            m_OutputStream << "      Starting execution of scenario step \"" << name << "\" - " <<
-                    m_CurrentStepIndex << " of " << m_NumberOfStepsInScenario <<
-                    " (" << std::setprecision(3) << GetProgressPercentage() << "%)" << "\"" << std::endl <<
-                    "      Description: " << description << std::endl;
-            m_StepPassed = true;
+        void ExecutingStepTeardown() {
+            m_First.ExecutingStepTeardown();
+            m_Rest.ExecutingStepTeardown();
         }
 
-        void ExecutingStepSetup() override {
-            m_OutputStream << "        Running scenario step setup..." << std::endl;
+        void FinishedScenario() {
+            m_First.FinishedScenario();
+            m_Rest.FinishedScenario();
         }
 
-        void RunningStepExpectations() override {
-            m_OutputStream << "        Running scenario step expectations..." << std::endl;
+        void FinishedTestSuite() {
+            m_First.FinishedTestSuite();
+            m_Rest.FinishedTestSuite();
         }
 
-        void StartingStepAct() override {
-            m_OutputStream << "        Starting scenario step act..." << std::endl;
+        void ScenarioCrashed(const std::string& reason) {
+            m_First.ScenarioCrashed(reason);
+            m_Rest.ScenarioCrashed(reason);
         }
 
-        void ExceptionInScenario() override {
-            m_OutputStream << "      Exception thrown during execution of scenario; terminated!" << std::endl;
-            ++m_NumberOfScenariosTerminated;
+        void ScenarioBranched(std::size_t numberOfBranches) {
+            m_First.ScenarioBranched(numberOfBranches);
+            m_Rest.ScenarioBranched(numberOfBranches);
         }
 
-        void StepExceptionExpectationNotMet(bool didThrow) override {
-            m_OutputStream << "        " <<
-                    (didThrow ? "Unexpected exception was thrown!" : "Expected exception was not thrown!") << std::endl;
-            m_StepPassed = m_StepPassed && false;
+        void ResumedFromCheckpoint(std::size_t numberOfStepsSkipped) {
+            m_First.ResumedFromCheckpoint(numberOfStepsSkipped);
+            m_Rest.ResumedFromCheckpoint(numberOfStepsSkipped);
         }
 
-        void StartingStepVerification() override {
-            m_OutputStream << "        Starting scenario step verification..." << std::endl;
+        void ScenarioCached() {
+            m_First.ScenarioCached();
+            m_Rest.ScenarioCached();
         }
 
-        void FinishedStepVerification(bool passed) override {
-            m_OutputStream << "        Scenario step verification " << (passed ? "passed." : "failed!") << std::endl;
-            m_StepPassed = m_StepPassed && passed;
+        void ScenariosDropped(std::size_t numberOfScenarios) {
+            m_First.ScenariosDropped(numberOfScenarios);
+            m_Rest.ScenariosDropped(numberOfScenarios);
         }
 
-        void StepVerificationFailed(const std::map<int, std::string>& failedCheckOutputs) override {
-            m_OutputStream << "        Failed step checks:" << std::endl;
-            for (const auto& checkOutput : failedCheckOutputs)
-                m_OutputStream << "          Check #" << checkOutput.first << " => " << checkOutput.second << std::endl;
+        void StepTimed(const AccTestStepTiming& timing) {
+            m_First.StepTimed(timing);
+            m_Rest.StepTimed(timing);
+        }
+
+        void ScenarioTimed(const AccTestScenarioTiming& timing) {
+            m_First.ScenarioTimed(timing);
+            m_Rest.ScenarioTimed(timing);
+        }
+
+        void StepBenchmarked(const AccTestBenchmarkResult& result) {
+            m_First.StepBenchmarked(result);
+            m_Rest.StepBenchmarked(result);
+        }
+
+        void StepChecksFailed(const AccTestCheckRecords& failedChecks) {
+            m_First.StepChecksFailed(failedChecks);
+            m_Rest.StepChecksFailed(failedChecks);
+        }
+
+    private:
+        First& m_First;
+        AccTestObserverList<Rest...> m_Rest;
+    };
+
+    // Exposes a static observer through AccTestObserverIface for the few places that need the interface: the benchmark steps 
+    // reporting from RunAct and the scenarios with branches, which record and replay the events of their common part.
+
+    template <typename ObserverType>
+    class AccTestObserverAdapter : public AccTestObserverIface {
+    public:
+
+        AccTestObserverAdapter(ObserverType& observer)
+        : m_Observer(observer) {
+        }
+
+        void StartingTestSuite(std::size_t numberOfTestScenarios) override {
+            m_Observer.StartingTestSuite(numberOfTestScenarios);
+        }
+
+        void StartingScenario(const std::string& name, const std::string& description, std::size_t numberOfSteps) override {
+            m_Observer.StartingScenario(name, description, numberOfSteps);
+        }
+
+        void ExceptionInScenario() override {
+            m_Observer.ExceptionInScenario();
+        }
+
+        void StartingScenarioSetup() override {
+            m_Observer.StartingScenarioSetup();
+        }
+
+        void ScenarioTerminated() override {
+            m_Observer.ScenarioTerminated();
+        }
+
+        void RunningScenarioTeardown() override {
+            m_Observer.RunningScenarioTeardown();
+        }
+
+        void StartingScenarioStep(const std::string& name, const std::string& description) override {
+            m_Observer.StartingScenarioStep(name, description);
+        }
+
+        void ExecutingStepSetup() override {
+            m_Observer.ExecutingStepSetup();
+        }
+
+        void RunningStepExpectations() override {
+            m_Observer.RunningStepExpectations();
+        }
+
+        void StartingStepAct() override {
+            m_Observer.StartingStepAct();
+        }
+
+        void StepExceptionExpectationNotMet(bool didThrow) override {
+            m_Observer.StepExceptionExpectationNotMet(didThrow);
+        }
+
+        void StartingStepVerification() override {
+            m_Observer.StartingStepVerification();
+        }
+
+        void FinishedStepVerification(bool passed) override {
+            m_Observer.FinishedStepVerification(passed);
+        }
+
+        void StepVerificationFailed(const std::map<int, std::string>& failedCheckOutputs) override {
+            m_Observer.StepVerificationFailed(failedCheckOutputs);
         }
 
         void ExecutingStepTeardown() override {
-            m_OutputStream << "        Running scenario step tear-down..." << std::endl << std::endl;
-            if (m_StepPassed)
-                ++m_NumberOfStepsPassed;
+            m_Observer.ExecutingStepTeardown();
+        }
+
+        void FinishedScenario() override {
+            m_Observer.FinishedScenario();
+        }
+
+        void FinishedTestSuite() override {
+            m_Observer.FinishedTestSuite();
+        }
+
+        void ScenarioCrashed(const std::string& reason) override {
+            m_Observer.ScenarioCrashed(reason);
+        }
+
+        void ScenarioBranched(std::size_t numberOfBranches) override {
+            m_Observer.ScenarioBranched(numberOfBranches);
+        }
+
+        void ResumedFromCheckpoint(std::size_t numberOfStepsSkipped) override {
+            m_Observer.ResumedFromCheckpoint(numberOfStepsSkipped);
+        }
+
+        void ScenarioCached() override {
+            m_Observer.ScenarioCached();
+        }
+
+        void ScenariosDropped(std::size_t numberOfScenarios) override {
+            m_Observer.ScenariosDropped(numberOfScenarios);
+        }
+
+        void StepTimed(const AccTestStepTiming& timing) override {
+            m_Observer.StepTimed(timing);
+        }
+
+        void ScenarioTimed(const AccTestScenarioTiming& timing) override {
+            m_Observer.ScenarioTimed(timing);
+        }
+
+        void StepBenchmarked(const AccTestBenchmarkResult& result) override {
+            m_Observer.StepBenchmarked(result);
+        }
+
+        void StepChecksFailed(const AccTestCheckRecords& failedChecks) override {
+            m_Observer.StepChecksFailed(failedChecks);
+        }
+
+    private:
+        ObserverType& m_Observer;
+    };
+
+    // Records the observer events of a single scenario so they can be replayed into another observer later on. When scenarios 
+    // run concurrently, each one reports to its own recorder and the suite replays the recorded events into the real observer
+    // one scenario at a time. This keeps observers such as AccTestObserver, which rely on receiving the events of a scenario as
+    // an uninterrupted sequence, free of any locking of their own.
+
+    enum class AccTestEventType {
+        StartingTestSuite, StartingScenario, ExceptionInScenario, StartingScenarioSetup, ScenarioTerminated,
+        RunningScenarioTeardown, StartingScenarioStep, ExecutingStepSetup, RunningStepExpectations, StartingStepAct,
+        StepExceptionExpectationNotMet, StartingStepVerification, FinishedStepVerification, StepVerificationFailed,
+        ExecutingStepTeardown, FinishedScenario, FinishedTestSuite, ScenarioCrashed, ScenarioBranched, ResumedFromCheckpoint,
+        StepTimed, ScenarioTimed, StepBenchmarked, StepChecksFailed, ScenarioCached, ScenariosDropped
+    };
+
+    struct AccTestEvent {
+
+        AccTestEvent(AccTestEventType type = AccTestEventType::FinishedScenario)
+        : Type(type) {
+        }
+
+        AccTestEventType Type;
+        std::string Name;
+        std::string Description;
+        std::size_t Count = 0;
+        bool Flag = false;
+        std::map<int, std::string> CheckOutputs;
+        std::vector<AccTestCheckRecord> CheckRecords;
+        std::string CheckOutput;
+        AccTestStepTiming StepTiming;
+        AccTestScenarioTiming ScenarioTiming;
+        AccTestBenchmarkResult BenchmarkResult;
+    };
+
+    class AccTestEventRecorder : public AccTestObserverIface {
+    public:
+
+        void StartingTestSuite(std::size_t numberOfTestScenarios) override {
+            AccTestEvent event(AccTestEventType::StartingTestSuite);
+            event.Count = numberOfTestScenarios;
+            Record(event);
+        }
+
+        void StartingScenario(const std::string& name, const std::string& description, std::size_t numberOfSteps) override {
+            AccTestEvent event(AccTestEventType::StartingScenario);
+            event.Name = name;
+            event.Description = description;
+            event.Count = numberOfSteps;
+            Record(event);
+        }
+
+        void ExceptionInScenario() override {
+            Record(AccTestEvent(AccTestEventType::ExceptionInScenario));
+        }
+
+        void StartingScenarioSetup() override {
+            Record(AccTestEvent(AccTestEventType::StartingScenarioSetup));
+        }
+
+        void ScenarioTerminated() override {
+            Record(AccTestEvent(AccTestEventType::ScenarioTerminated));
+        }
+
+        void RunningScenarioTeardown() override {
+            Record(AccTestEvent(AccTestEventType::RunningScenarioTeardown));
+        }
+
+        void StartingScenarioStep(const std::string& name, const std::string& description) override {
+            AccTestEvent event(AccTestEventType::StartingScenarioStep);
+            event.Name = name;
+            event.Description = description;
+            Record(event);
+        }
+
+        void ExecutingStepSetup() override {
+            Record(AccTestEvent(AccTestEventType::ExecutingStepSetup));
+        }
+
+        void RunningStepExpectations() override {
+            Record(AccTestEvent(AccTestEventType::RunningStepExpectations));
+        }
+
+        void StartingStepAct() override {
+            Record(AccTestEvent(AccTestEventType::StartingStepAct));
+        }
+
+        void StepExceptionExpectationNotMet(bool didThrow) override {
+            AccTestEvent event(AccTestEventType::StepExceptionExpectationNotMet);
+            event.Flag = didThrow;
+            Record(event);
+        }
+
+        void StartingStepVerification() override {
+            Record(AccTestEvent(AccTestEventType::StartingStepVerification));
+        }
+
+        void FinishedStepVerification(bool passed) override {
+            AccTestEvent event(AccTestEventType::FinishedStepVerification);
+            event.Flag = passed;
+            Record(event);
+        }
+
+        void StepVerificationFailed(const std::map<int, std::string>& failedCheckOutputs) override {
+            AccTestEvent event(AccTestEventType::StepVerificationFailed);
+            event.CheckOutputs = failedCheckOutputs;
+            Record(event);
+        }
+
+        void ExecutingStepTeardown() override {
+            Record(AccTestEvent(AccTestEventType::ExecutingStepTeardown));
+        }
+
+        void FinishedScenario() override {
+            Record(AccTestEvent(AccTestEventType::FinishedScenario));
+        }
+
+        void FinishedTestSuite() override {
+            Record(AccTestEvent(AccTestEventType::FinishedTestSuite));
+        }
+
+        void ScenarioCrashed(const std::string& reason) override {
+            AccTestEvent event(AccTestEventType::ScenarioCrashed);
+            event.Description = reason;
+            Record(event);
+        }
+
+        void ScenarioBranched(std::size_t numberOfBranches) override {
+            AccTestEvent event(AccTestEventType::ScenarioBranched);
+            event.Count = numberOfBranches;
+            Record(event);
+        }
+
+        void ResumedFromCheckpoint(std::size_t numberOfStepsSkipped) override {
+            AccTestEvent event(AccTestEventType::ResumedFromCheckpoint);
+            event.Count = numberOfStepsSkipped;
+            Record(event);
+        }
+
+        void ScenarioCached() override {
+            Record(AccTestEvent(AccTestEventType::ScenarioCached));
+        }
+
+        void ScenariosDropped(std::size_t numberOfScenarios) override {
+            AccTestEvent event(AccTestEventType::ScenariosDropped);
+            event.Count = numberOfScenarios;
+            Record(event);
+        }
+
+        void StepTimed(const AccTestStepTiming& timing) override {
+            AccTestEvent event(AccTestEventType::StepTimed);
+            event.StepTiming = timing;
+            Record(event);
+        }
+
+        void ScenarioTimed(const AccTestScenarioTiming& timing) override {
+            AccTestEvent event(AccTestEventType::ScenarioTimed);
+            event.ScenarioTiming = timing;
+            Record(event);
+        }
+
+        void StepChecksFailed(const AccTestCheckRecords& failedChecks) override {
+            AccTestEvent event(AccTestEventType::StepChecksFailed);
+            event.CheckRecords = failedChecks.GetRecords();
+            event.CheckOutput = failedChecks.GetOutput();
+            Record(event);
+        }
+
+        void StepBenchmarked(const AccTestBenchmarkResult& result) override {
+            AccTestEvent event(AccTestEventType::StepBenchmarked);
+            event.BenchmarkResult = result;
+            Record(event);
+        }
+
+        const std::vector<AccTestEvent>& GetEvents() const {
+            return m_Events;
+        }
+
+        void Clear() {
+            m_Events.clear();
+        }
+
+        void Replay(AccTestObserverIface& observer) const {
+            for (const auto& event : m_Events)
+                ReplayEvent(event, observer);
+        }
+
+        static void ReplayEvent(const AccTestEvent& event, AccTestObserverIface& observer) {
+            switch (event.Type) {
+                case AccTestEventType::StartingTestSuite: observer.StartingTestSuite(event.Count); break;
+                case AccTestEventType::StartingScenario:
+                    observer.StartingScenario(event.Name, event.Description, event.Count);
+                    break;
+                case AccTestEventType::ExceptionInScenario: observer.ExceptionInScenario(); break;
+                case AccTestEventType::StartingScenarioSetup: observer.StartingScenarioSetup(); break;
+                case AccTestEventType::ScenarioTerminated: observer.ScenarioTerminated(); break;
+                case AccTestEventType::RunningScenarioTeardown: observer.RunningScenarioTeardown(); break;
+                case AccTestEventType::StartingScenarioStep:
+                    observer.StartingScenarioStep(event.Name, event.Description);
+                    break;
+                case AccTestEventType::ExecutingStepSetup: observer.ExecutingStepSetup(); break;
+                case AccTestEventType::RunningStepExpectations: observer.RunningStepExpectations(); break;
+                case AccTestEventType::StartingStepAct: observer.StartingStepAct(); break;
+                case AccTestEventType::StepExceptionExpectationNotMet: observer.StepExceptionExpectationNotMet(event.Flag); break;
+                case AccTestEventType::StartingStepVerification: observer.StartingStepVerification(); break;
+                case AccTestEventType::FinishedStepVerification: observer.FinishedStepVerification(event.Flag); break;
+                case AccTestEventType::StepVerificationFailed: observer.StepVerificationFailed(event.CheckOutputs); break;
+                case AccTestEventType::ExecutingStepTeardown: observer.ExecutingStepTeardown(); break;
+                case AccTestEventType::FinishedScenario: observer.FinishedScenario(); break;
+                case AccTestEventType::FinishedTestSuite: observer.FinishedTestSuite(); break;
+                case AccTestEventType::ScenarioCrashed: observer.ScenarioCrashed(event.Description); break;
+                case AccTestEventType::ScenarioBranched: observer.ScenarioBranched(event.Count); break;
+                case AccTestEventType::ResumedFromCheckpoint: observer.ResumedFromCheckpoint(event.Count); break;
+                case AccTestEventType::StepTimed: observer.StepTimed(event.StepTiming); break;
+                case AccTestEventType::ScenarioTimed: observer.ScenarioTimed(event.ScenarioTiming); break;
+                case AccTestEventType::StepBenchmarked: observer.StepBenchmarked(event.BenchmarkResult); break;
+                case AccTestEventType::StepChecksFailed:
+                    observer.StepChecksFailed(AccTestCheckRecords(event.CheckRecords, event.CheckOutput));
+                    break;
+                case AccTestEventType::ScenarioCached: observer.ScenarioCached(); break;
+                case AccTestEventType::ScenariosDropped: observer.ScenariosDropped(event.Count); break;
+            }
+        }
+
+    protected:
+
+        virtual void Record(const AccTestEvent& event) {
+            m_Events.push_back(event);
+        }
+
+    private:
+        std::vector<AccTestEvent> m_Events;
+    };
+
+    // Turns events into bytes and back so they can be sent from one process to another. Each event is written as a frame: 
+    // the size of the frame body as four bytes followed by the body, which starts with the event type. Integers are written 
+    // in little endian order and strings are preceded by their length; points in time and durations are written as numbers of
+    // clock ticks, which is meaningful to another process as long as it runs on the same machine. Decode returns false as long 
+    // as the buffer holds no complete frame, so the bytes can be fed to it in whatever pieces they arrive.
+
+    class AccTestEventCodec {
+    public:
+
+        static void Encode(const AccTestEvent& event, std::string& buffer) {
+            std::string body;
+            body.push_back(static_cast<char> (event.Type));
+            WriteString(event.Name, body);
+            WriteString(event.Description, body);
+            WriteInteger(event.Count, 8, body);
+            body.push_back(event.Flag ? 1 : 0);
+            WriteInteger(event.CheckOutputs.size(), 4, body);
+            for (const auto& checkOutput : event.CheckOutputs) {
+                WriteInteger(static_cast<unsigned int> (checkOutput.first), 4, body);
+                WriteString(checkOutput.second, body);
+            }
+            if (event.Type == AccTestEventType::StepTimed) {
+                const auto& timing = event.StepTiming;
+                WriteTicks(timing.Start.time_since_epoch(), body);
+                for (auto phase : {timing.Setup, timing.Expect, timing.Act, timing.Verify, timing.Teardown})
+                    WriteTicks(phase, body);
+            } else if (event.Type == AccTestEventType::ScenarioTimed) {
+                const auto& timing = event.ScenarioTiming;
+                WriteTicks(timing.Start.time_since_epoch(), body);
+                for (auto phase : {timing.Setup, timing.Steps, timing.Teardown})
+                    WriteTicks(phase, body);
+            } else if (event.Type == AccTestEventType::StepBenchmarked) {
+                const auto& result = event.BenchmarkResult;
+                WriteInteger(result.WarmupIterations, 8, body);
+                WriteInteger(result.Iterations, 8, body);
+                for (auto statistic : {result.Min, result.Median, result.Mean, result.P90, result.P99, result.Max, result.StdDev})
+                    WriteTicks(statistic, body);
+            } else if (event.Type == AccTestEventType::StepChecksFailed) {
+                WriteInteger(event.CheckRecords.size(), 4, body);
+                for (const auto& record : event.CheckRecords) {
+                    WriteInteger(static_cast<unsigned int> (record.CheckIndex), 4, body);
+                    WriteString(record.Site.File ? record.Site.File : "", body);
+                    WriteInteger(static_cast<unsigned int> (record.Site.Line), 4, body);
+                    WriteString(record.Site.Expression ? record.Site.Expression : "", body);
+                    WriteInteger(record.OutputStart, 8, body);
+                }
+                WriteString(event.CheckOutput, body);
+            }
+            WriteInteger(body.size(), 4, buffer);
+            buffer += body;
+        }
+
+        static bool Decode(const std::string& buffer, std::size_t& position, AccTestEvent& event) {
+            if (buffer.size() - position < 4)
+                return false;
+            auto bodyPosition = position;
+            auto bodySize = static_cast<std::size_t> (ReadInteger(buffer, bodyPosition, 4));
+            if (buffer.size() - bodyPosition < bodySize)
+                return false;
+            event = AccTestEvent(static_cast<AccTestEventType> (buffer[bodyPosition++]));
+            event.Name = ReadString(buffer, bodyPosition);
+            event.Description = ReadString(buffer, bodyPosition);
+            event.Count = static_cast<std::size_t> (ReadInteger(buffer, bodyPosition, 8));
+            event.Flag = buffer[bodyPosition++] != 0;
+            auto numberOfCheckOutputs = ReadInteger(buffer, bodyPosition, 4);
+            for (unsigned long long index = 0; index < numberOfCheckOutputs; ++index) {
+                auto checkIndex = static_cast<int> (ReadInteger(buffer, bodyPosition, 4));
+                event.CheckOutputs[checkIndex] = ReadString(buffer, bodyPosition);
+            }
+            if (event.Type == AccTestEventType::StepTimed) {
+                auto& timing = event.StepTiming;
+                timing.Start = AccTestClock::time_point(ReadTicks(buffer, bodyPosition));
+                for (auto phase : {&timing.Setup, &timing.Expect, &timing.Act, &timing.Verify, &timing.Teardown})
+                    *phase = ReadTicks(buffer, bodyPosition);
+            } else if (event.Type == AccTestEventType::ScenarioTimed) {
+                auto& timing = event.ScenarioTiming;
+                timing.Start = AccTestClock::time_point(ReadTicks(buffer, bodyPosition));
+                for (auto phase : {&timing.Setup, &timing.Steps, &timing.Teardown})
+                    *phase = ReadTicks(buffer, bodyPosition);
+            } else if (event.Type == AccTestEventType::StepBenchmarked) {
+                auto& result = event.BenchmarkResult;
+                result.WarmupIterations = static_cast<std::size_t> (ReadInteger(buffer, bodyPosition, 8));
+                result.Iterations = static_cast<std::size_t> (ReadInteger(buffer, bodyPosition, 8));
+                for (auto statistic : {&result.Min, &result.Median, &result.Mean, &result.P90, &result.P99, &result.Max,
+                        &result.StdDev})
+                    *statistic = ReadTicks(buffer, bodyPosition);
+            } else if (event.Type == AccTestEventType::StepChecksFailed) {
+                auto numberOfRecords = ReadInteger(buffer, bodyPosition, 4);
+                for (unsigned long long index = 0; index < numberOfRecords; ++index) {
+                    AccTestCheckRecord record;
+                    record.CheckIndex = static_cast<int> (ReadInteger(buffer, bodyPosition, 4));
+                    auto file = ReadString(buffer, bodyPosition);
+                    record.Site.File = file.empty() ? nullptr : AccTestCheckSite::Intern(file);
+                    record.Site.Line = static_cast<int> (ReadInteger(buffer, bodyPosition, 4));
+                    auto expression = ReadString(buffer, bodyPosition);
+                    record.Site.Expression = expression.empty() ? nullptr : AccTestCheckSite::Intern(expression);
+                    record.OutputStart = static_cast<std::size_t> (ReadInteger(buffer, bodyPosition, 8));
+                    event.CheckRecords.push_back(record);
+                }
+                event.CheckOutput = ReadString(buffer, bodyPosition);
+            }
+            position = bodyPosition;
+            return true;
+        }
+
+    private:
+
+        static void WriteInteger(unsigned long long value, int numberOfBytes, std::string& buffer) {
+            for (int byte = 0; byte < numberOfBytes; ++byte)
+                buffer.push_back(static_cast<char> ((value >> (8 * byte)) & 0xFF));
+        }
+
+        static unsigned long long ReadInteger(const std::string& buffer, std::size_t& position, int numberOfBytes) {
+            unsigned long long value = 0;
+            for (int byte = 0; byte < numberOfBytes; ++byte)
+                value |= static_cast<unsigned long long> (static_cast<unsigned char> (buffer[position++])) << (8 * byte);
+            return value;
+        }
+
+        static void WriteTicks(AccTestClock::duration duration, std::string& buffer) {
+            WriteInteger(static_cast<unsigned long long> (duration.count()), 8, buffer);
+        }
+
+        static AccTestClock::duration ReadTicks(const std::string& buffer, std::size_t& position) {
+            return AccTestClock::duration(static_cast<AccTestClock::rep> (ReadInteger(buffer, position, 8)));
+        }
+
+        static void WriteString(const std::string& text, std::string& buffer) {
+            WriteInteger(text.size(), 4, buffer);
+            buffer += text;
+        }
+
+        static std::string ReadString(const std::string& buffer, std::size_t& position) {
+            auto size = static_cast<std::size_t> (ReadInteger(buffer, position, 4));
+            position += size;
+            return buffer.substr(position - size, size);
+        }
+    };
+
+#ifdef ACC_TEST_POSIX
+
+    // Helpers for passing events between processes through pipes.
+
+    class AccTestPipe {
+    public:
+
+        static bool WriteAll(int fd, const std::string& data) {
+            std::size_t written = 0;
+            while (written < data.size()) {
+                auto result = write(fd, data.data() + written, data.size() - written);
+                if (result < 0 && errno == EINTR)
+                    continue;
+                if (result <= 0)
+                    return false;
+                written += static_cast<std::size_t> (result);
+            }
+            return true;
+        }
+
+        static bool ReadAll(int fd, char* data, std::size_t size) {
+            std::size_t received = 0;
+            while (received < size) {
+                auto result = read(fd, data + received, size - received);
+                if (result < 0 && errno == EINTR)
+                    continue;
+                if (result <= 0)
+                    return false;
+                received += static_cast<std::size_t> (result);
+            }
+            return true;
+        }
+
+        // Reads whatever is available, up to a few kilobytes, and appends it to the buffer. Returns false at the end of the 
+        // stream.
+        static bool ReadSome(int fd, std::string& buffer) {
+            char chunk[4096];
+            auto received = read(fd, chunk, sizeof (chunk));
+            if (received < 0 && errno == EINTR)
+                return true;
+            if (received <= 0)
+                return false;
+            buffer.append(chunk, static_cast<std::size_t> (received));
+            return true;
+        }
+
+        static void FlushStandardStreams() {
+            std::cout.flush();
+            std::cerr.flush();
+            std::fflush(nullptr);
+        }
+
+        static int WaitFor(pid_t pid) {
+            int status = 0;
+            while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+            }
+            return status;
+        }
+
+        static std::string DescribeExitStatus(int status) {
+            std::ostringstream description;
+            if (WIFSIGNALED(status))
+                description << "was killed by signal " << WTERMSIG(status) << " (" << strsignal(WTERMSIG(status)) << ")";
             else
-                ++m_NumberOfStepsFailed;
+                description << "exited with status " << WEXITSTATUS(status);
+            return description.str();
+        }
+    };
+
+    // Streams each event through a pipe as soon as it is reported, so the reading process keeps everything that was reported
+    // before the writing process died.
+
+    class AccTestEventPipeWriter : public AccTestEventRecorder {
+    public:
+
+        AccTestEventPipeWriter(int fd)
+        : m_Fd(fd) {
+        }
+
+    protected:
+
+        void Record(const AccTestEvent& event) override {
+            std::string frame;
+            AccTestEventCodec::Encode(event, frame);
+            AccTestPipe::WriteAll(m_Fd, frame);
+        }
+
+    private:
+        int m_Fd;
+    };
+
+#endif // ACC_TEST_POSIX
+
+    // Hashes used to tell whether something has changed since an earlier run, e.g. the test program itself. The hash of the 
+    // test program is taken from /proc/self/exe where that exists and otherwise from the path passed to SetExecutablePath, 
+    // which AccTestRunner does with argv[0]; it is 0 if neither can be read.
+
+    class AccTestFingerprint {
+    public:
+
+        static unsigned long long Hash(const std::string& data, unsigned long long hash = 14695981039346656037ULL) {
+            for (auto character : data)
+                hash = (hash ^ static_cast<unsigned char> (character)) * 1099511628211ULL;
+            return hash;
+        }
+
+        static bool HashFile(const std::string& path, unsigned long long& hash) {
+            std::ifstream input(path.c_str(), std::ios::binary);
+            if (!input)
+                return false;
+            hash = Hash("");
+            std::vector<char> chunk(1 << 16);
+            while (input.read(&chunk[0], chunk.size()) || input.gcount() > 0)
+                hash = Hash(std::string(&chunk[0], static_cast<std::size_t> (input.gcount())), hash);
+            return true;
+        }
+
+        static void SetExecutablePath(const std::string& path) {
+            GetExecutablePath() = path;
+        }
+
+        static unsigned long long GetExecutableHash() {
+            static std::once_flag once;
+            static unsigned long long executableHash = 0;
+            std::call_once(once, []() {
+                if (!HashFile("/proc/self/exe", executableHash) && !HashFile(GetExecutablePath(), executableHash))
+                    executableHash = 0;
+            });
+            return executableHash;
+        }
+
+        static std::string ToHex(unsigned long long hash) {
+            std::ostringstream hex;
+            hex << std::hex << std::setw(16) << std::setfill('0') << hash;
+            return hex.str();
+        }
+
+    private:
+
+        static std::string& GetExecutablePath() {
+            static std::string path;
+            return path;
+        }
+    };
+
+    // Checkpoints and baselines are written under a temporary name and renamed when complete. The temporary name is unique 
+    // to the process and thread writing the file, so that scenarios saving the same file at the same time, e.g. repeats run 
+    // concurrently, don't write into each other's temporary file; the last one to be renamed wins.
+
+    class AccTestTemporaryFile {
+    public:
+
+        static std::string GetPath(const std::string& path) {
+            std::ostringstream temporaryPath;
+            temporaryPath << path << "." << GetProcessId() << "." << std::hash<std::thread::id>()(std::this_thread::get_id()) <<
+                    ".tmp";
+            return temporaryPath.str();
+        }
+
+        // Renames the temporary file to path, or removes it if that fails.
+        static bool Replace(const std::string& temporaryPath, const std::string& path) {
+            if (std::rename(temporaryPath.c_str(), path.c_str()) == 0)
+                return true;
+            std::remove(temporaryPath.c_str());
+            return false;
+        }
+
+    private:
+
+        static unsigned long long GetProcessId() {
+#ifdef ACC_TEST_POSIX
+            return static_cast<unsigned long long> (getpid());
+#else
+            static const unsigned long long processId = std::random_device()();
+            return processId;
+#endif
+        }
+    };
+
+    // Where the baseline timings of the performance checks (see AccTestStep::CheckBaseline) are kept and how they are compared.
+    // Baselines are only used if Directory names an existing directory. With Update turned on, the checks store the current 
+    // timings as the new baselines instead of comparing against them. A check fails if the current timings are significantly 
+    // slower than the baseline according to a one-sided Mann-Whitney U test at the Significance level and, at the same time,
+    // their median is more than Threshold (a fraction, 0.1 being 10%) above the median of the baseline.
+
+    struct AccTestBaselineOptions {
+        std::string Directory;
+        bool Update = false;
+        double Threshold = 0.1;
+        double Significance = 0.01;
+    };
+
+    // Stores the timings of performance checks in files named after the scenario and step they belong to. Each file holds a 
+    // header line with the number of timings followed by the timings in nanoseconds, one per line. Like checkpoints, the files
+    // are written under a temporary name and renamed when complete.
+
+    class AccTestBaselineStore {
+    public:
+
+        AccTestBaselineStore(const std::string& directory)
+        : m_Directory(directory) {
+        }
+
+        bool Save(const std::string& key, const std::vector<AccTestClock::duration>& samples) {
+            auto path = GetPath(key);
+            auto temporaryPath = AccTestTemporaryFile::GetPath(path);
+            {
+                std::ofstream output(temporaryPath.c_str());
+                output << "ProTest baseline " << samples.size() << "\n";
+                for (auto sample : samples)
+                    output << std::chrono::duration_cast<std::chrono::nanoseconds>(sample).count() << "\n";
+                if (!output) {
+                    output.close();
+                    std::remove(temporaryPath.c_str());
+                    return false;
+                }
+            }
+            return AccTestTemporaryFile::Replace(temporaryPath, path);
+        }
+
+        bool Load(const std::string& key, std::vector<AccTestClock::duration>& samples) {
+            std::ifstream input(GetPath(key).c_str());
+            std::string magic, kind;
+            std::size_t count;
+            if (!(input >> magic >> kind >> count) || magic != "ProTest" || kind != "baseline")
+                return false;
+            samples.clear();
+            long long nanoseconds;
+            while (samples.size() < count && input >> nanoseconds)
+                samples.push_back(std::chrono::duration_cast<AccTestClock::duration>(std::chrono::nanoseconds(nanoseconds)));
+            return samples.size() == count;
+        }
+
+    private:
+
+        std::string GetPath(const std::string& key) {
+            std::string safeName;
+            for (auto character : key)
+                safeName.push_back(std::isalnum(static_cast<unsigned char> (character)) ? character : '_');
+            return m_Directory + "/" + safeName + "-" + AccTestFingerprint::ToHex(AccTestFingerprint::Hash(key)) + ".baseline";
+        }
+
+        std::string m_Directory;
+    };
+
+    // The outcome of comparing timings against their baseline as described for AccTestBaselineOptions. PValue is the 
+    // probability of the current timings ranking at least this high against the baseline if both came from the same 
+    // distribution, computed with the normal approximation of the U statistic corrected for ties and continuity.
+
+    struct AccTestBaselineComparison {
+        AccTestClock::duration Median = AccTestClock::duration::zero();
+        AccTestClock::duration BaselineMedian = AccTestClock::duration::zero();
+        double PValue = 1;
+        bool Regressed = false;
+
+        static AccTestBaselineComparison Compare(const std::vector<AccTestClock::duration>& samples, 
+                const std::vector<AccTestClock::duration>& baseline, const AccTestBaselineOptions& options) {
+            AccTestBaselineComparison comparison;
+            if (samples.empty() || baseline.empty())
+                return comparison;
+            comparison.Median = AccTestBenchmarkResult::FromSamples(samples, 0).Median;
+            comparison.BaselineMedian = AccTestBenchmarkResult::FromSamples(baseline, 0).Median;
+            comparison.PValue = GetMannWhitneyPValue(samples, baseline);
+            comparison.Regressed = comparison.PValue < options.Significance && 
+                    comparison.Median.count() > comparison.BaselineMedian.count() * (1 + options.Threshold);
+            return comparison;
+        }
+
+        static double GetMannWhitneyPValue(const std::vector<AccTestClock::duration>& samples, 
+                const std::vector<AccTestClock::duration>& baseline) {
+            std::vector<std::pair<AccTestClock::duration, bool> > pooled;
+            for (auto sample : samples)
+                pooled.push_back(std::make_pair(sample, true));
+            for (auto sample : baseline)
+                pooled.push_back(std::make_pair(sample, false));
+            std::sort(pooled.begin(), pooled.end());
+            double n1 = static_cast<double> (samples.size()), n2 = static_cast<double> (baseline.size()), n = n1 + n2;
+            double rankSum = 0, tieCorrection = 0;
+            for (std::size_t first = 0; first < pooled.size();) {
+                auto last = first;
+                while (last + 1 < pooled.size() && pooled[last + 1].first == pooled[first].first)
+                    ++last;
+                double ties = static_cast<double> (last - first + 1);
+                double averageRank = (first + last) / 2.0 + 1;
+                for (auto index = first; index <= last; ++index)
+                    if (pooled[index].second)
+                        rankSum += averageRank;
+                tieCorrection += ties * ties * ties - ties;
+                first = last + 1;
+            }
+            double u = rankSum - n1 * (n1 + 1) / 2;
+            double variance = n1 * n2 / 12 * ((n + 1) - tieCorrection / (n * (n - 1)));
+            if (variance <= 0)
+                return 1;
+            double z = (u - n1 * n2 / 2 - 0.5) / std::sqrt(variance);
+            return 0.5 * std::erfc(z / std::sqrt(2.0));
+        }
+    };
+
+    // Writes the operands of failed checks to the check output. Values are written with operator<< where there is one, ranges 
+    // such as the standard containers as their elements in braces, and anything else as {?}.
+
+    class AccTestValueFormatter {
+    public:
+
+        template <typename T>
+        static void Format(std::ostream& output, const T& value) {
+            FormatValue(output, value, 0);
+        }
+
+        static void Format(std::ostream& output, bool value) {
+            output << (value ? "true" : "false");
+        }
+
+        static void Format(std::ostream& output, std::nullptr_t) {
+            output << "nullptr";
+        }
+
+    private:
+
+        template <typename T>
+        static auto FormatValue(std::ostream& output, const T& value, int) -> decltype(void(output << value)) {
+            output << value;
+        }
+
+        template <typename T>
+        static auto FormatValue(std::ostream& output, const T& value, long) -> decltype(void(std::begin(value) != std::end(value))) {
+            output << "{";
+            const char* separator = "";
+            for (auto element = std::begin(value); element != std::end(value); ++element) {
+                output << separator;
+                Format(output, *element);
+                separator = ", ";
+            }
+            output << "}";
+        }
+
+        template <typename T>
+        static void FormatValue(std::ostream& output, const T&, ...) {
+            output << "{?}";
+        }
+    };
+
+    // The expressions captured by ACC_TEST_CHECK. The operands are evaluated exactly once, when the expression is captured, and
+    // are only formatted if the check fails.
+    // Only the first comparison of "a < b && b < c" would be captured, and the rest would be joined to it rather than to the
+    // whole comparison, so && and || on captured expressions stop the compilation with a message asking for parentheses.
+
+    template <typename T>
+    struct AccTestUnparenthesizedLogicalOperator {
+        static_assert(sizeof(T) == 0, "ACC_TEST_CHECK can't capture && or ||; put the expression in parentheses, e.g. "
+                "ACC_TEST_CHECK((a < b && b < c)).");
+        typedef void Type;
+    };
+
+    class AccTestExpression {
+    public:
+
+        AccTestExpression(bool result)
+        : m_Result(result) {
+        }
+
+        bool GetResult() const {
+            return m_Result;
+        }
+
+        virtual void Format(std::ostream& output) const = 0;
+
+    protected:
+        ~AccTestExpression() {
+        }
+
+    private:
+        bool m_Result;
+    };
+
+    template <typename L, typename R>
+    class AccTestBinaryExpression : public AccTestExpression {
+    public:
+
+        AccTestBinaryExpression(bool result, const L& left, const char* comparison, const R& right)
+        : AccTestExpression(result), m_Left(left), m_Comparison(comparison), m_Right(right) {
+        }
+
+        void Format(std::ostream& output) const override {
+            AccTestValueFormatter::Format(output, m_Left);
+            output << " " << m_Comparison << " ";
+            AccTestValueFormatter::Format(output, m_Right);
+        }
+
+        template <typename T>
+        typename AccTestUnparenthesizedLogicalOperator<T>::Type operator&&(const T&) const {
+        }
+
+        template <typename T>
+        typename AccTestUnparenthesizedLogicalOperator<T>::Type operator||(const T&) const {
+        }
+
+    private:
+        const L& m_Left;
+        const char* m_Comparison;
+        const R& m_Right;
+    };
+
+    template <typename L>
+    class AccTestUnaryExpression : public AccTestExpression {
+    public:
+
+        AccTestUnaryExpression(const L& value)
+        : AccTestExpression(static_cast<bool> (value)), m_Value(value) {
+        }
+
+        void Format(std::ostream& output) const override {
+            AccTestValueFormatter::Format(output, m_Value);
+        }
+
+    private:
+        const L& m_Value;
+    };
+
+    // The left operand of a captured expression. Comparing it to the right operand captures the comparison; used on its own, it
+    // is turned into an AccTestUnaryExpression by AccTestStep::CheckExpression.
+
+    template <typename L>
+    class AccTestExpressionOperand {
+    public:
+
+        AccTestExpressionOperand(const L& value)
+        : m_Value(value) {
+        }
+
+        const L& GetValue() const {
+            return m_Value;
+        }
+
+        template <typename R>
+        AccTestBinaryExpression<L, R> operator==(const R& right) const {
+            return AccTestBinaryExpression<L, R>(m_Value == right, m_Value, "==", right);
+        }
+
+        template <typename R>
+        AccTestBinaryExpression<L, R> operator!=(const R& right) const {
+            return AccTestBinaryExpression<L, R>(m_Value != right, m_Value, "!=", right);
+        }
+
+        template <typename R>
+        AccTestBinaryExpression<L, R> operator<(const R& right) const {
+            return AccTestBinaryExpression<L, R>(m_Value < right, m_Value, "<", right);
+        }
+
+        template <typename R>
+        AccTestBinaryExpression<L, R> operator<=(const R& right) const {
+            return AccTestBinaryExpression<L, R>(m_Value <= right, m_Value, "<=", right);
+        }
+
+        template <typename R>
+        AccTestBinaryExpression<L, R> operator>(const R& right) const {
+            return AccTestBinaryExpression<L, R>(m_Value > right, m_Value, ">", right);
+        }
+
+        template <typename R>
+        AccTestBinaryExpression<L, R> operator>=(const R& right) const {
+            return AccTestBinaryExpression<L, R>(m_Value >= right, m_Value, ">=", right);
+        }
+
+        template <typename T>
+        typename AccTestUnparenthesizedLogicalOperator<T>::Type operator&&(const T&) const {
+        }
+
+        template <typename T>
+        typename AccTestUnparenthesizedLogicalOperator<T>::Type operator||(const T&) const {
+        }
+
+    private:
+        const L& m_Value;
+    };
+
+    // ACC_TEST_CHECK puts an instance of this in front of the checked expression: "AccTestExpressionDecomposer() <= a == b" 
+    // binds as "(AccTestExpressionDecomposer() <= a) == b", which captures both operands. Expressions joined by && or || must
+    // be put in parentheses and are then captured as a single value; without them the check doesn't compile.
+
+    struct AccTestExpressionDecomposer {
+        template <typename L>
+        AccTestExpressionOperand<L> operator<=(const L& value) const {
+            return AccTestExpressionOperand<L>(value);
+        }
+    };
+
+    // A stream buffer appending whatever is written to it to a string, which can be read in place and emptied without giving 
+    // up its capacity.
+
+    class AccTestStringBuffer : public std::streambuf {
+    public:
+
+        const std::string& GetText() const {
+            return m_Text;
+        }
+
+        void Clear() {
+            m_Text.clear();
+        }
+
+        void Truncate(std::size_t size) {
+            m_Text.resize(size);
+        }
+
+    protected:
+
+        int_type overflow(int_type character) override {
+            if (!traits_type::eq_int_type(character, traits_type::eof()))
+                m_Text.push_back(traits_type::to_char_type(character));
+            return traits_type::not_eof(character);
+        }
+
+        std::streamsize xsputn(const char_type* text, std::streamsize count) override {
+            m_Text.append(text, static_cast<std::size_t> (count));
+            return count;
+        }
+
+    private:
+        std::string m_Text;
+    };
+
+    // Each test step must inherit AccTestStep and override one or more of the virtual methods. Your derived constructor must 
+    // the base constructor and give it the name, description, and the flags isRequired and mustThrow. Turning isRequired on for 
+    // test step means that its success is essential for proceeding to subsequent steps. If a required test step fails, all 
+    // subsequent steps will be omitted. Turning on the mustThrow flag means that the executing the step Action must throw an 
+    // exception. If this flag is raised but the action doesn't throw, the step fails. 
+    // You will almost certainly want to override the Act() method. This is where the action happens - some 
+    // message is sent to the application, an event is raised, etc. Just make that your implementation of Act() calls SetActed() 
+    // at the end.
+    // If you are using mock objects in your test, you should override Expect() and put your expectations there. But don't forget
+    // to verify them in Verify().
+    // You will also, almost very certainly, want to override Verify() to see if the action has had the expected effect on the 
+    // context - otherwise, what's the point of testing! If you are using mock objects in your context, make sure to verify all the
+    // expectations or reset them before the context is handed over to the unsuspecting next step. Use the protected Check() 
+    // method within your Verify() implementation to check if a certain condition is met. If the condition is true the test step is 
+    // considered passed. If one of the Check invocations within the test step is given a false value, the whole step is considered
+    // failed. You can pass data to the return value from the Check() calls. This data will be sent to the output if the check 
+    // should fail.
+    // If you need somewhere to initialize the context before running the step, you will need to override Setup(). The finalizing
+    // counterpart is, of course, Teardown().
+    // The ACC_TEST_CHECK and ACC_TEST_CHECK_EQUAL macros are shortcuts to Check() that evaluate their operands only once and
+    // only format them if the check fails, which keeps passing checks cheap.
+    // To guard against performance regressions, pass the durations you measured to CheckBaseline() within Verify(). It is a 
+    // check like the ones made by Check() that compares them against the baseline stored for the step (see 
+    // AccTestBaselineOptions); it passes if there is no baseline to compare against yet and stores the durations as one.
+
+    template <typename T>
+    class AccTestStep {
+    public:
+        typedef T TestContextType;
+
+        AccTestStep(const std::string& name, const std::string& description, bool isRequired = false, bool mustThrow = false)
+        : m_Name(name), m_Description(description), m_IsRequired(isRequired), m_MustThrow(mustThrow) {
+        }
+
+        virtual void Setup() {
+        }
+
+        virtual void Expect() {
+        }
+
+        virtual void Act() {
+        }
+
+        virtual void Verify() {
+            Check(true);
+        }
+
+        virtual void Teardown() {
+        }
+
+        // Runs the action of the step; the scenario calls this rather than Act() itself so that steps such as 
+        // AccTestBenchmarkStep can run the action more than once.
+        virtual void RunAct(AccTestObserverIface& /*testObserver*/) {
+            Act();
+        }
+
+        void SetContext(TestContextType* context) {
+            m_Context = context;
+        }
+
+        // The options and the name belong to the scenario running the step, which outlives it; the key of the baseline is
+        // only built by CheckBaseline, and only when baselines are in use.
+        void SetBaseline(const AccTestBaselineOptions* options, const std::string* scenarioName) {
+            m_BaselineOptions = options;
+            m_ScenarioName = scenarioName;
+        }
+
+        bool Passed() {
+            return m_Passed;
+        }
+
+        bool IsVerified() {
+            return m_IsVerified;
+        }
+
+        bool MustThrow() {
+            return m_MustThrow;
+        }
+
+        bool IsRequired() {
+            return m_IsRequired;
+        }
+
+        std::string GetName() {
+            return m_Name;
+        }
+
+        std::string GetDescription() {
+            return m_Description;
+        }
+
+        std::map<int, std::string> GetCheckOutputs() {
+            return GetFailedChecks().ToMap();
+        }
+
+        AccTestCheckRecords GetFailedChecks() {
+            return AccTestCheckRecords(m_FailedChecks, m_FailedCheckBuffer.GetText());
+        }
+
+        // Forgets the outcome of all the checks made so far; the scenario does this before running the step.
+        void ResetChecks() {
+            m_IsVerified = m_Passed = false;
+            m_CheckCounter = 0;
+            m_FailedChecks.clear();
+            m_FailedCheckBuffer.Clear();
+            m_FailedCheckOutput.clear();
+        }
+
+    protected:
+
+        TestContextType* GetTestContext() {
+            return m_Context;
+        }
+
+        // The output of passing checks is discarded: the returned stream has no buffer and is in a failed state, so anything 
+        // written to it is dropped without even being formatted. The outputs of failed checks are all written to the same 
+        // buffer, each one starting where the previous one ended.
+        std::ostream& Check(bool predicate, const AccTestCheckSite& site = AccTestCheckSite()) {
+            m_Passed = m_CheckCounter > 0 ? m_Passed && predicate : predicate;
+            m_IsVerified = true;
+            m_CheckCounter++;
+            if (predicate)
+                return m_DiscardedCheckOutput;
+            m_FailedCheckOutput.clear();
+            AccTestCheckRecord record;
+            record.CheckIndex = m_CheckCounter;
+            record.Site = site;
+            record.OutputStart = m_FailedCheckBuffer.GetText().size();
+            m_FailedChecks.push_back(record);
+            return m_FailedCheckOutput;
+        }
+
+        std::ostream& CheckExpression(const AccTestExpression& expression, const AccTestCheckSite& site) {
+            auto& output = Check(expression.GetResult(), site);
+            if (!expression.GetResult()) {
+                output << "FAILED: " << site.Expression << " WITH EXPANSION: ";
+                expression.Format(output);
+            }
+            return output;
+        }
+
+        template <typename L>
+        std::ostream& CheckExpression(const AccTestExpressionOperand<L>& operand, const AccTestCheckSite& site) {
+            return CheckExpression(AccTestUnaryExpression<L>(operand.GetValue()), site);
+        }
+
+        template <typename L, typename R>
+        std::ostream& CheckEqual(const L& left, const R& right, const char* leftText, const char* rightText, 
+                const AccTestCheckSite& site = AccTestCheckSite()) {
+            bool equal = left == right;
+            auto& output = Check(equal, site);
+            if (!equal) {
+                output << "NOT EQUAL: " << leftText << " = ";
+                AccTestValueFormatter::Format(output, left);
+                output << ", " << rightText << " = ";
+                AccTestValueFormatter::Format(output, right);
+            }
+            return output;
+        }
+
+        std::ostream& CheckBaseline(const std::vector<AccTestClock::duration>& samples) {
+            if (!m_BaselineOptions || m_BaselineOptions->Directory.empty())
+                return Check(true);
+            AccTestBaselineStore store(m_BaselineOptions->Directory);
+            auto key = (m_ScenarioName ? *m_ScenarioName : std::string()) + "/" + m_Name;
+            std::vector<AccTestClock::duration> baseline;
+            if (m_BaselineOptions->Update || !store.Load(key, baseline))
+                return Check(store.Save(key, samples)) << "Unable to store the baseline of " << key << ". ";
+            auto comparison = AccTestBaselineComparison::Compare(samples, baseline, *m_BaselineOptions);
+            return Check(!comparison.Regressed) << "Timing regressed against the baseline: median " << 
+                    std::chrono::duration<double, std::milli>(comparison.Median).count() << " ms vs. " << 
+                    std::chrono::duration<double, std::milli>(comparison.BaselineMedian).count() << " ms, Mann-Whitney p = " << 
+                    comparison.PValue << ". ";
+        }
+
+    private:
+
+        bool m_IsVerified = false;
+        bool m_IsRequired = false;
+        bool m_MustThrow = false;
+        bool m_Passed = false;
+        std::string m_Name = "NOT SET";
+        std::string m_Description = "NOT SET";
+        TestContextType* m_Context = nullptr;
+        std::vector<AccTestCheckRecord> m_FailedChecks;
+        AccTestStringBuffer m_FailedCheckBuffer;
+        std::ostream m_FailedCheckOutput {&m_FailedCheckBuffer};
+        std::ostream m_DiscardedCheckOutput {nullptr};
+        int m_CheckCounter = 0;
+        const AccTestBaselineOptions* m_BaselineOptions = nullptr;
+        const std::string* m_ScenarioName = nullptr;
+    };
+
+    // How many times a benchmark step runs its action. The warm-up iterations run first and aren't measured. After them, the 
+    // action is run and measured until either MaxIterations iterations are done (if MaxIterations isn't 0) or TimeBudget has 
+    // passed since the first measured iteration started, but no less than MinIterations times.
+
+    struct AccTestBenchmarkOptions {
+        std::size_t WarmupIterations = 1;
+        std::size_t MinIterations = 1;
+        std::size_t MaxIterations = 0;
+        AccTestClock::duration TimeBudget = std::chrono::seconds(1);
+    };
+
+    // A test step that measures the performance of its action. Override Act() as you would for any other step; it is run 
+    // repeatedly according to the benchmark options, and only the time spent inside Act() is measured. Anything that must be 
+    // done before or after every single iteration, such as restoring the state the action changes, belongs in 
+    // IterationSetup() and IterationTeardown(), which are kept out of the measurement. Setup() and Teardown() still run once 
+    // for the whole step. The statistics are reported to the observer through StepBenchmarked and are available to Verify() 
+    // through GetBenchmarkResult() along with the raw durations of the iterations through GetSamples(). If an iteration throws,
+    // the benchmark stops there and the step is handled as any other step whose action threw. Unless overridden, Verify() 
+    // checks the durations of the iterations against their baseline.
+
+    template <typename T>
+    class AccTestBenchmarkStep : public AccTestStep<T> {
+    public:
+
+        AccTestBenchmarkStep(const std::string& name, const std::string& description, 
+                const AccTestBenchmarkOptions& options = AccTestBenchmarkOptions(), bool isRequired = false)
+        : AccTestStep<T>(name, description, isRequired), m_Options(options) {
+        }
+
+        virtual void IterationSetup() {
+        }
+
+        virtual void IterationTeardown() {
+        }
+
+        void Verify() override {
+            CheckBaseline();
+        }
+
+        void RunAct(AccTestObserverIface& testObserver) override {
+            m_Samples.clear();
+            for (std::size_t i = 0; i < m_Options.WarmupIterations; ++i)
+                RunIteration();
+            auto start = AccTestClock::now();
+            while (m_Samples.size() < m_Options.MinIterations || 
+                    ((m_Options.MaxIterations == 0 || m_Samples.size() < m_Options.MaxIterations) && 
+                    AccTestClock::now() - start < m_Options.TimeBudget))
+                m_Samples.push_back(RunIteration());
+            m_Result = AccTestBenchmarkResult::FromSamples(m_Samples, m_Options.WarmupIterations);
+            testObserver.StepBenchmarked(m_Result);
+        }
+
+        const AccTestBenchmarkOptions& GetBenchmarkOptions() const {
+            return m_Options;
+        }
+
+        void SetBenchmarkOptions(const AccTestBenchmarkOptions& options) {
+            m_Options = options;
+        }
+
+        const AccTestBenchmarkResult& GetBenchmarkResult() const {
+            return m_Result;
+        }
+
+        const std::vector<AccTestClock::duration>& GetSamples() const {
+            return m_Samples;
+        }
+
+    protected:
+        using AccTestStep<T>::CheckBaseline;
+
+        std::ostream& CheckBaseline() {
+            return CheckBaseline(m_Samples);
+        }
+
+    private:
+
+        AccTestClock::duration RunIteration() {
+            IterationSetup();
+            auto start = AccTestClock::now();
+            this->Act();
+            auto duration = AccTestClock::now() - start;
+            IterationTeardown();
+            return duration;
+        }
+
+        AccTestBenchmarkOptions m_Options;
+        AccTestBenchmarkResult m_Result;
+        std::vector<AccTestClock::duration> m_Samples;
+    };
+
+    // Where scenario checkpoints (see AccTestScenario::CreateCheckpoint) are kept and whether to resume from them. Checkpoints 
+    // are only saved and loaded if Directory names an existing directory. ResumeFromStep is the number of the first step 
+    // (counting from 1) that should actually run; the scenario continues from the latest valid checkpoint saved before that 
+    // step. 0 runs the whole scenario and ResumeFromLatest continues from the latest valid checkpoint there is. Checkpoints 
+    // are only valid for the build of the test program that saved them, told apart by the hash of the executable or by 
+    // ProgramFingerprint if that is set, e.g. to the hash of the library a suite was loaded from.
+
+    struct AccTestCheckpointOptions {
+        static const std::size_t ResumeFromLatest = static_cast<std::size_t> (-1);
+
+        std::string Directory;
+        std::size_t ResumeFromStep = 0;
+        std::string ProgramFingerprint;
+    };
+
+    // Stores checkpoints of scenario contexts in files named after the scenario and the step after which they were taken. 
+    // Each file starts with a header holding the fingerprint of the test program, the hash of the names and descriptions of all the 
+    // steps of the scenario, and the size of the serialized context. A checkpoint is only loaded if all three still match, so
+    // rebuilding the test program or changing the steps invalidates it. Files are written under a temporary name and renamed
+    // when complete, so an interrupted run never leaves a half written checkpoint behind.
+
+    class AccTestCheckpointStore {
+    public:
+
+        AccTestCheckpointStore(const std::string& directory, const std::string& scenarioName, const std::string& stepListHash,
+                const std::string& programFingerprint = std::string())
+        : m_Directory(directory), m_ScenarioName(scenarioName), m_StepListHash(stepListHash), 
+        m_ProgramFingerprint(programFingerprint) {
+            if (m_ProgramFingerprint.empty())
+                m_ProgramFingerprint = AccTestFingerprint::ToHex(AccTestFingerprint::GetExecutableHash());
+        }
+
+        bool Save(std::size_t numberOfSteps, const std::string& context) {
+            auto path = GetPath(numberOfSteps);
+            auto temporaryPath = AccTestTemporaryFile::GetPath(path);
+            {
+                std::ofstream output(temporaryPath.c_str(), std::ios::binary);
+                output << GetHeader(context.size()) << context;
+                if (!output) {
+                    output.close();
+                    std::remove(temporaryPath.c_str());
+                    return false;
+                }
+            }
+            return AccTestTemporaryFile::Replace(temporaryPath, path);
+        }
+
+        bool Load(std::size_t numberOfSteps, std::string& context) {
+            std::ifstream input(GetPath(numberOfSteps).c_str(), std::ios::binary);
+            if (!input)
+                return false;
+            std::ostringstream contents;
+            contents << input.rdbuf();
+            auto text = contents.str();
+            auto headerEnd = text.find('\n');
+            if (headerEnd == std::string::npos)
+                return false;
+            context = text.substr(headerEnd + 1);
+            return text.substr(0, headerEnd + 1) == GetHeader(context.size());
+        }
+
+    private:
+
+        std::string GetPath(std::size_t numberOfSteps) {
+            std::string safeName;
+            for (auto character : m_ScenarioName)
+                safeName.push_back(std::isalnum(static_cast<unsigned char> (character)) ? character : '_');
+            std::ostringstream path;
+            path << m_Directory << "/" << safeName << "-" << AccTestFingerprint::ToHex(AccTestFingerprint::Hash(m_ScenarioName)) <<
+                    "." << numberOfSteps << ".checkpoint";
+            return path.str();
+        }
+
+        std::string GetHeader(std::size_t contextSize) {
+            std::ostringstream header;
+            header << "ProTest checkpoint " << m_ProgramFingerprint << " " << m_StepListHash << " " << contextSize << "\n";
+            return header.str();
+        }
+
+        std::string m_Directory;
+        std::string m_ScenarioName;
+        std::string m_StepListHash;
+        std::string m_ProgramFingerprint;
+    };
+
+    // Provides a base for all scenario classes so they can be aggregated within the test suite and run polymorphically.
+
+    class AccTestScenarioBase {
+    public:
+
+        AccTestScenarioBase(const std::string& name, const std::string& description)
+        : m_Name(name), m_Description(description) {
+        }
+
+        virtual void Run(const std::shared_ptr<AccTestObserverIface>& testObserver) = 0;
+
+        virtual std::vector<std::string> GetStepNames() = 0;
+
+        // A hash of the names and descriptions of all the steps, which changes whenever the steps do. Checkpoints and the result
+        // cache of the suite depend on it.
+        virtual std::string GetStepListHash() = 0;
+
+        void SetCheckpointOptions(const AccTestCheckpointOptions& checkpointOptions) {
+            m_CheckpointOptions = checkpointOptions;
+        }
+
+        void SetBaselineOptions(const AccTestBaselineOptions& baselineOptions) {
+            m_BaselineOptions = baselineOptions;
+        }
+
+        // The suite running the scenario provides the shared fixtures it asks for with GetFixture.
+        typedef std::function<std::shared_ptr<void>(const std::string& name, const std::type_info& type)> FixtureProviderType;
+
+        void SetFixtureProvider(const FixtureProviderType& fixtureProvider) {
+            m_FixtureProvider = fixtureProvider;
+        }
+
+        const std::string& GetName() {
+            return m_Name;
+        }
+
+        std::string GetDescription() {
+            return m_Description;
+        }
+
+    protected:
+
+        const AccTestCheckpointOptions& GetCheckpointOptions() {
+            return m_CheckpointOptions;
+        }
+
+        const AccTestBaselineOptions& GetBaselineOptions() {
+            return m_BaselineOptions;
+        }
+
+        // Returns a fixture the scenario shares with the other scenarios of the suite (see AccTestSuite::CreateFixture), which
+        // is built by the first scenario asking for it. The scenario has to list the fixture in the Fixtures of its 
+        // AccTestScenarioInfo, and keeps it alive for as long as the scenario exists. Call it from Setup rather than from the
+        // constructor, so that scenarios which are constructed but not run don't build fixtures.
+        template <class FixtureType>
+        FixtureType& GetFixture(const std::string& name) {
+            if (!m_FixtureProvider)
+                throw std::logic_error("The scenario " + m_Name + " isn't run by a suite, which would provide the fixture " + name);
+            auto& fixture = m_Fixtures[name];
+            fixture = m_FixtureProvider(name, typeid(FixtureType));
+            return *static_cast<FixtureType*> (fixture.get());
+        }
+
+    private:
+        std::string m_Name = "NOT SET";
+        std::string m_Description = "NOT SET";
+        AccTestCheckpointOptions m_CheckpointOptions;
+        AccTestBaselineOptions m_BaselineOptions;
+        FixtureProviderType m_FixtureProvider;
+        std::map<std::string, std::shared_ptr<void>> m_Fixtures;
+    };
+
+    // Tells AccTestScenario how to give each branch of a scenario its own copy of the test context. A copyable context is 
+    // copied; for any other context the branch runs in a forked child process, which gets a copy of the whole process. 
+    // Specialize this template and set IsCopyable to false for a context that can be copied but whose copies would still share
+    // state, e.g. through raw pointers to fakes, so its branches are forked instead.
+
+    template <class T>
+    struct AccTestContextTraits {
+        static const bool IsCopyable = std::is_copy_constructible<T>::value;
+    };
+
+    // Tells whether a test context has a Reset() method, which makes AccTestScenario take its contexts from a pool.
+
+    template <class T>
+    class AccTestHasReset {
+        template <class U>
+        static auto Check(U* context) -> decltype(context->Reset(), std::true_type());
+
+        template <class U>
+        static std::false_type Check(...);
+
+    public:
+        static const bool value = decltype(Check<T>(nullptr))::value;
+    };
+
+    // The contexts of one type that finished scenarios have given back, to be handed out again instead of new ones. A context
+    // is reset with its Reset() method as it comes back; if Reset() throws, the context is destroyed instead. The pool never 
+    // holds more contexts than there were scenarios using them at the same time, and keeps them until the program exits.
+
+    template <class T>
+    class AccTestContextPool {
+    public:
+
+        static std::unique_ptr<T> Acquire() {
+            auto& pool = GetInstance();
+            {
+                std::lock_guard<std::mutex> lock(pool.m_Mutex);
+                if (!pool.m_Contexts.empty()) {
+                    auto context = std::move(pool.m_Contexts.back());
+                    pool.m_Contexts.pop_back();
+                    return context;
+                }
+            }
+            return std::unique_ptr<T>(new T());
+        }
+
+        static void Release(std::unique_ptr<T> context) {
+            try {
+                context->Reset();
+            } catch (...) {
+                return;
+            }
+            auto& pool = GetInstance();
+            std::lock_guard<std::mutex> lock(pool.m_Mutex);
+            pool.m_Contexts.push_back(std::move(context));
+        }
+
+    private:
+
+        static AccTestContextPool& GetInstance() {
+            static AccTestContextPool pool;
+            return pool;
+        }
+
+        std::mutex m_Mutex;
+        std::vector< std::unique_ptr<T> > m_Contexts;
+    };
+
+    // The test context of a scenario: a plain member, or for a context with a Reset() method one taken from its 
+    // AccTestContextPool when first used and given back when the scenario is destroyed.
+
+    template <class T, bool IsPooled = AccTestHasReset<T>::value>
+    class AccTestContextHolder {
+    public:
+
+        T* Get() {
+            return &m_Context;
+        }
+
+    private:
+        T m_Context;
+    };
+
+    template <class T>
+    class AccTestContextHolder<T, true> {
+    public:
+
+        AccTestContextHolder() = default;
+        AccTestContextHolder(const AccTestContextHolder&) = delete;
+        AccTestContextHolder& operator=(const AccTestContextHolder&) = delete;
+
+        ~AccTestContextHolder() {
+            if (m_Context)
+                AccTestContextPool<T>::Release(std::move(m_Context));
+        }
+
+        T* Get() {
+            if (!m_Context)
+                m_Context = AccTestContextPool<T>::Acquire();
+            return m_Context.get();
+        }
+
+    private:
+        std::unique_ptr<T> m_Context;
+    };
+
+    // A test scenario which is composed of multiple steps must inherit AccTestScenario. You should create your test steps 
+    // within the constructor of your derived class and add them in the same order as you want them to be executed. Use AddStep() 
+    // to add the next test step.
+    // The test context is created and is accessible within you derived class as GetTestContext.
+    // Override Setup and Teardown to provide code for test context initialization and finalization before and after serial 
+    // execution of the steps. This is probably where you will want to create you application object and related test stubs, etc. 
+    // Don't forget to get rid of everything in Teardown. 
+    // When the scenario is run (by a call to Run), first the Setup() method is called once, then all the test steps are executed 
+    // in the order they were added, and finally the Teardown() method is called to wrap up the test. Executing each step 
+    // involves calling its Setup, Expect, Act, Verify, and Teardown methods in the same order.
+    // After executing Run(), you can retrieve the test results using GetReport(). You can use a AccTestReportFormatter to format 
+    // the report as text and send it to an output stream.
+    // When subclassing, pass the name and description of the test scenario to the base constructor. These information will 
+    // subsequently be available using GetName and GetDescription.
+    // Scenarios that only differ in their last few steps can share their common steps by branching: create the common steps 
+    // first, then call BeginBranch for each alternative continuation and create its steps right after it. When run, Setup and
+    // the common steps are executed once; then every branch continues from its own copy of the context as it was after the 
+    // common steps (see AccTestContextTraits), and finally Teardown is called once on the original context. Each branch is 
+    // reported as a scenario of its own, named "<scenario name>/<branch name>", including the common steps. A context copy 
+    // should not share anything a branch might change with the original; a forked branch ends with its process, so no 
+    // cleanup happens there. Forking is only safe while the process runs no other threads, i.e. when the scenarios are run 
+    // serially or in worker processes.
+    // Long scenarios can save checkpoints of their context so a later run can skip the steps before a checkpoint (see 
+    // AccTestCheckpointOptions). Call CreateCheckpoint right after creating a step to save the context once that step has 
+    // passed, and override SaveContext and LoadContext to write the context to a stream and read it back; LoadContext is 
+    // called after Setup() and must restore everything the skipped steps would have done. A checkpoint is only saved if all 
+    // the steps before it passed. Checkpoints are not supported in scenarios with branches: a scenario calling both 
+    // CreateCheckpoint and BeginBranch fails to construct, and the suite reports it as terminated with the reason.
+    // Give the context a Reset() method to have scenarios reuse the contexts of scenarios that have finished, e.g. when a suite 
+    // is run with many repeats: the context then comes from an AccTestContextPool instead of being constructed with the 
+    // scenario, and Reset() has to bring it back to the state of a new context. Keeping what it owns, such as fakes and the
+    // capacity of its containers, rather than freeing and allocating it again is what makes the reuse pay.
+
+    template <class T>
+    class AccTestScenario : public AccTestScenarioBase {
+    public:
+        typedef T TestContextType;
+
+        AccTestScenario(const std::string& name, const std::string& description)
+        : AccTestScenarioBase(name, description) {
+        }
+
+        void Run(const std::shared_ptr<AccTestObserverIface>& testObserver) override {
+            RunWith(*testObserver);
+        }
+
+        // Runs the scenario reporting to an observer of a type known at compile time, e.g. an AccTestNullObserver derivative 
+        // or an AccTestObserverList, whose callbacks are then called directly rather than through AccTestObserverIface. Run 
+        // is RunWith reporting to the interface. A scenario with branches reports through an AccTestObserverAdapter.
+        template <typename ObserverType>
+        void RunWith(ObserverType& testObserver) {
+            if (!m_Branches.empty()) {
+                RunBranches(testObserver);
+                return;
+            }
+            testObserver.StartingScenario(GetName(), GetDescription(), m_Steps.size());
+            AccTestScenarioTiming timing;
+            timing.Start = AccTestClock::now();
+            try {
+                RunUnprotected(testObserver, timing);
+            } catch (...) {
+                testObserver.ExceptionInScenario();
+            }
+            timing.Steps = AccTestClock::now() - timing.Start - timing.Setup - timing.Teardown;
+            testObserver.ScenarioTimed(timing);
+            testObserver.FinishedScenario();
+        }
+
+        std::vector<std::string> GetStepNames() override {
+            std::vector<std::string> names;
+            for (const auto& step : m_Steps)
+                names.push_back(step->GetName());
+            for (const auto& branch : m_Branches) {
+                for (const auto& step : branch.Steps)
+                    names.push_back(step->GetName());
+            }
+            return names;
+        }
+
+        std::string GetStepListHash() override {
+            std::string stepList;
+            for (const auto& step : m_Steps)
+                stepList += step->GetName() + "\n" + step->GetDescription() + "\n";
+            for (const auto& branch : m_Branches) {
+                stepList += "/" + branch.Name + "\n" + branch.Description + "\n";
+                for (const auto& step : branch.Steps)
+                    stepList += step->GetName() + "\n" + step->GetDescription() + "\n";
+            }
+            return AccTestFingerprint::ToHex(AccTestFingerprint::Hash(stepList));
+        }
+
+    protected:
+
+        template <class StepType, class... Args>
+        void CreateStep(Args... constructionArgs) {
+            (m_Branches.empty() ? m_Steps : m_Branches.back().Steps).push_back(std::make_shared<StepType>(constructionArgs...));
+        }
+
+        // Throws std::logic_error in a scenario with branches.
+        void CreateCheckpoint() {
+            if (!m_Branches.empty())
+                throw std::logic_error(GetCheckpointsInBranchesMessage());
+            m_CheckpointSteps.push_back(m_Steps.size());
+        }
+
+        // Starts a new branch; the steps created from here on up to the next call belong to it. Throws std::logic_error in a 
+        // scenario with checkpoints.
+        void BeginBranch(const std::string& name, const std::string& description) {
+            if (!m_CheckpointSteps.empty())
+                throw std::logic_error(GetCheckpointsInBranchesMessage());
+            Branch branch;
+            branch.Name = name;
+            branch.Description = description;
+            m_Branches.push_back(branch);
+        }
+
+        TestContextType* GetTestContext() {
+            return m_TestContext.Get();
+        }
+
+    private:
+
+        std::string GetCheckpointsInBranchesMessage() {
+            return "The scenario " + GetName() + " has both branches and checkpoints; scenarios with branches can't take "
+                    "checkpoints or be resumed from them with --resume-from.";
+        }
+
+        class ScenarioSetup {
+        public:
+
+            ScenarioSetup(AccTestScenario* scenario, AccTestScenarioTiming& timing)
+            : m_Scenario(scenario), m_Timing(timing) {
+                auto start = AccTestClock::now();
+                m_Scenario->Setup();
+                m_Timing.Setup = AccTestClock::now() - start;
+            }
+
+            ~ScenarioSetup() {
+                auto start = AccTestClock::now();
+                m_Scenario->Teardown();
+                m_Timing.Teardown = AccTestClock::now() - start;
+            }
+
+        private:
+            AccTestScenario<TestContextType>* m_Scenario;
+            AccTestScenarioTiming& m_Timing;
+        };
+
+        class StepSetup {
+        public:
+
+            StepSetup(AccTestStep<TestContextType>* step, AccTestStepTiming& timing)
+            : m_Step(step), m_Timing(timing) {
+                m_Timing.Start = AccTestClock::now();
+                m_Step->Setup();
+                m_Timing.Setup = AccTestClock::now() - m_Timing.Start;
+            }
+
+            ~StepSetup() {
+                auto start = AccTestClock::now();
+                if (!m_Step->IsVerified())
+                    m_Step->Verify();
+                auto teardownStart = AccTestClock::now();
+                m_Timing.Verify += teardownStart - start;
+                m_Step->Teardown();
+                m_Timing.Teardown = AccTestClock::now() - teardownStart;
+            }
+
+        private:
+            AccTestStep<TestContextType>* m_Step;
+            AccTestStepTiming& m_Timing;
+        };
+
+        virtual void Setup() {
+        }
+
+        virtual void Teardown() {
+        }
+
+        virtual bool SaveContext(std::ostream& /*output*/) {
+            return false;
+        }
+
+        virtual bool LoadContext(std::istream& /*input*/) {
+            return false;
+        }
+
+        typedef std::vector< std::shared_ptr< AccTestStep<TestContextType> > > StepList;
+
+        struct Branch {
+            std::string Name;
+            std::string Description;
+            StepList Steps;
+        };
+
+        template <typename ObserverType>
+        void RunUnprotected(ObserverType& testObserver, AccTestScenarioTiming& timing) {
+            testObserver.StartingScenarioSetup();
+            ScenarioSetup scenSetup(this, timing);
+            bool allStepsPassed = true;
+            for (auto stepIndex = ResumeFromCheckpoint(testObserver); stepIndex < m_Steps.size(); ++stepIndex) {
+                const auto& step = m_Steps[stepIndex];
+                auto stepPassed = RunStepUnprotected(step, m_TestContext.Get(), testObserver);
+                allStepsPassed = allStepsPassed && stepPassed;
+                if (!stepPassed && step->IsRequired()) {
+                    testObserver.ScenarioTerminated();
+                    break;
+                }
+                if (allStepsPassed)
+                    SaveCheckpoint(stepIndex + 1);
+            }
+            testObserver.RunningScenarioTeardown();
+        }
+
+        AccTestCheckpointStore GetCheckpointStore() {
+            const auto& options = GetCheckpointOptions();
+            return AccTestCheckpointStore(options.Directory, GetName(), GetStepListHash(), options.ProgramFingerprint);
+        }
+
+        void SaveCheckpoint(std::size_t numberOfSteps) {
+            if (GetCheckpointOptions().Directory.empty() ||
+                    std::find(m_CheckpointSteps.begin(), m_CheckpointSteps.end(), numberOfSteps) == m_CheckpointSteps.end())
+                return;
+            std::ostringstream context;
+            if (SaveContext(context))
+                GetCheckpointStore().Save(numberOfSteps, context.str());
+        }
+
+        // Returns the index of the first step to run.
+        template <typename ObserverType>
+        std::size_t ResumeFromCheckpoint(ObserverType& testObserver) {
+            const auto& options = GetCheckpointOptions();
+            if (options.Directory.empty() || options.ResumeFromStep == 0 || m_CheckpointSteps.empty())
+                return 0;
+            auto lastSkippedStep = options.ResumeFromStep == AccTestCheckpointOptions::ResumeFromLatest ? m_Steps.size() :
+                    options.ResumeFromStep - 1;
+            auto store = GetCheckpointStore();
+            for (auto checkpoint = m_CheckpointSteps.rbegin(); checkpoint != m_CheckpointSteps.rend(); ++checkpoint) {
+                std::string context;
+                if (*checkpoint > lastSkippedStep || !store.Load(*checkpoint, context))
+                    continue;
+                std::istringstream input(context);
+                if (LoadContext(input)) {
+                    testObserver.ResumedFromCheckpoint(*checkpoint);
+                    return *checkpoint;
+                }
+            }
+            return 0;
+        }
+
+        // Returns false if a required step failed.
+        template <typename ObserverType>
+        bool RunStepsUnprotected(const StepList& steps, TestContextType* context, ObserverType& testObserver) {
+            for (const auto& step : steps) {
+                auto requiredStepFailed = !RunStepUnprotected(step, context, testObserver) && step->IsRequired();
+                if (requiredStepFailed) {
+                    testObserver.ScenarioTerminated();
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        template <typename ObserverType>
+        void RunBranches(ObserverType& testObserver) {
+            AccTestObserverAdapter<ObserverType> dynamicObserver(testObserver);
+            RunBranches(static_cast<AccTestObserverIface&> (dynamicObserver));
+        }
+
+        // The events of Setup and the common steps are recorded once and repeated in the report of every branch. The timing
+        // of each branch covers Setup, the common steps, and its own steps; the single Teardown isn't attributed to any of them.
+        void RunBranches(AccTestObserverIface& testObserver) {
+            testObserver.ScenarioBranched(m_Branches.size());
+            auto commonEvents = std::make_shared<AccTestEventRecorder>();
+            AccTestScenarioTiming commonTiming;
+            commonTiming.Start = AccTestClock::now();
+            try {
+                commonEvents->StartingScenarioSetup();
+                ScenarioSetup scenSetup(this, commonTiming);
+                auto commonStepsPassed = RunStepsUnprotected(m_Steps, m_TestContext.Get(), *commonEvents);
+                commonTiming.Steps = AccTestClock::now() - commonTiming.Start - commonTiming.Setup;
+                if (commonStepsPassed) {
+                    for (const auto& branch : m_Branches)
+                        RunBranch(branch, *commonEvents, commonTiming, testObserver,
+                            std::integral_constant<bool, AccTestContextTraits<TestContextType>::IsCopyable>());
+                } else {
+                    for (const auto& branch : m_Branches) {
+                        StartBranch(branch, *commonEvents, testObserver);
+                        testObserver.RunningScenarioTeardown();
+                        FinishBranch(commonTiming, AccTestClock::duration::zero(), testObserver);
+                    }
+                }
+            } catch (...) {
+                commonTiming.Steps = AccTestClock::now() - commonTiming.Start - commonTiming.Setup;
+                for (const auto& branch : m_Branches) {
+                    StartBranch(branch, *commonEvents, testObserver);
+                    testObserver.ExceptionInScenario();
+                    FinishBranch(commonTiming, AccTestClock::duration::zero(), testObserver);
+                }
+            }
+        }
+
+        void FinishBranch(AccTestScenarioTiming timing, AccTestClock::duration branchSteps, AccTestObserverIface& testObserver) {
+            timing.Steps += branchSteps;
+            timing.Teardown = AccTestClock::duration::zero();
+            testObserver.ScenarioTimed(timing);
+            testObserver.FinishedScenario();
+        }
+
+        void StartBranch(const Branch& branch, const AccTestEventRecorder& commonEvents, AccTestObserverIface& testObserver) {
+            testObserver.StartingScenario(GetName() + "/" + branch.Name, branch.Description,
+                    m_Steps.size() + branch.Steps.size());
+            commonEvents.Replay(testObserver);
+        }
+
+        void RunBranch(const Branch& branch, const AccTestEventRecorder& commonEvents, const AccTestScenarioTiming& commonTiming,
+                AccTestObserverIface& testObserver, std::true_type /*copyableContext*/) {
+            StartBranch(branch, commonEvents, testObserver);
+            auto start = AccTestClock::now();
+            try {
+                TestContextType branchContext(*m_TestContext.Get());
+                RunStepsUnprotected(branch.Steps, &branchContext, testObserver);
+                testObserver.RunningScenarioTeardown();
+            } catch (...) {
+                testObserver.ExceptionInScenario();
+            }
+            FinishBranch(commonTiming, AccTestClock::now() - start, testObserver);
+        }
+
+        void RunBranch(const Branch& branch, const AccTestEventRecorder& commonEvents, const AccTestScenarioTiming& commonTiming,
+                AccTestObserverIface& testObserver, std::false_type /*copyableContext*/) {
+            StartBranch(branch, commonEvents, testObserver);
+            auto start = AccTestClock::now();
+#ifdef ACC_TEST_POSIX
+            int eventPipe[2];
+            if (pipe(eventPipe) != 0) {
+                testObserver.ExceptionInScenario();
+                FinishBranch(commonTiming, AccTestClock::now() - start, testObserver);
+                return;
+            }
+            AccTestPipe::FlushStandardStreams();
+            auto pid = fork();
+            if (pid < 0) {
+                close(eventPipe[0]);
+                close(eventPipe[1]);
+                testObserver.ExceptionInScenario();
+                FinishBranch(commonTiming, AccTestClock::now() - start, testObserver);
+                return;
+            }
+            if (pid == 0) {
+                close(eventPipe[0]);
+                auto eventWriter = std::make_shared<AccTestEventPipeWriter>(eventPipe[1]);
+                try {
+                    RunStepsUnprotected(branch.Steps, m_TestContext.Get(), *eventWriter);
+                    eventWriter->RunningScenarioTeardown();
+                } catch (...) {
+                    eventWriter->ExceptionInScenario();
+                }
+                AccTestPipe::FlushStandardStreams();
+                _exit(0);
+            }
+            close(eventPipe[1]);
+            std::string buffer;
+            std::size_t position = 0;
+            AccTestEvent event;
+            while (AccTestPipe::ReadSome(eventPipe[0], buffer)) {
+                while (AccTestEventCodec::Decode(buffer, position, event))
+                    AccTestEventRecorder::ReplayEvent(event, testObserver);
+            }
+            close(eventPipe[0]);
+            auto status = AccTestPipe::WaitFor(pid);
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+                testObserver.ScenarioCrashed(AccTestPipe::DescribeExitStatus(status));
+#else
+            testObserver.ExceptionInScenario();
+#endif
+            FinishBranch(commonTiming, AccTestClock::now() - start, testObserver);
+        }
+
+        template <typename ObserverType>
+        bool RunStepUnprotected(const std::shared_ptr< AccTestStep<TestContextType> >& step, TestContextType* context,
+                ObserverType& testObserver) {
+            testObserver.StartingScenarioStep(step->GetName(), step->GetDescription());
+            step->SetContext(context);
+            step->ResetChecks();
+            step->SetBaseline(&GetBaselineOptions(), &GetName());
+            AccTestStepTiming timing;
+            bool passed;
+            {
+                testObserver.ExecutingStepSetup();
+                StepSetup stepSetup(step.get(), timing);
+                testObserver.RunningStepExpectations();
+                auto phaseStart = AccTestClock::now();
+                step->Expect();
+                timing.Expect = AccTestClock::now() - phaseStart;
+                testObserver.StartingStepAct();
+                bool didThrow = false;
+                phaseStart = AccTestClock::now();
+                try {
+                    RunAct(*step, testObserver);
+                } catch (...) {
+                    didThrow = true;
+                }
+                timing.Act = AccTestClock::now() - phaseStart;
+                bool passedThrowReq = didThrow == step->MustThrow();
+                if (!passedThrowReq)
+                    testObserver.StepExceptionExpectationNotMet(didThrow);
+                else {
+                    testObserver.StartingStepVerification();
+                    phaseStart = AccTestClock::now();
+                    step->Verify();
+                    timing.Verify = AccTestClock::now() - phaseStart;
+                    testObserver.FinishedStepVerification(step->Passed());
+                    if (!step->Passed())
+                        testObserver.StepChecksFailed(step->GetFailedChecks());
+                }
+                testObserver.ExecutingStepTeardown();
+                passed = step->Passed();
+            }
+            testObserver.StepTimed(timing);
+            return passed;
+        }
+
+        // Benchmark steps report from RunAct through the interface, which a static observer reaches through an adapter.
+        template <typename ObserverType>
+        static void RunAct(AccTestStep<TestContextType>& step, ObserverType& testObserver) {
+            AccTestObserverAdapter<ObserverType> dynamicObserver(testObserver);
+            step.RunAct(dynamicObserver);
+        }
+
+        static void RunAct(AccTestStep<TestContextType>& step, AccTestObserverIface& testObserver) {
+            step.RunAct(testObserver);
+        }
+
+        StepList m_Steps;
+        std::vector<Branch> m_Branches;
+        std::vector<std::size_t> m_CheckpointSteps;
+        AccTestContextHolder<TestContextType> m_TestContext;
+    };
+
+    // The totals of a test suite run as printed by AccTestObserver at the end of the suite. Summaries of several runs over
+    // disjoint sets of scenarios, e.g. the shards of one suite executed on different machines, can be added up and printed 
+    // as if they came from a single run. WriteTo and ReadFrom store a summary in a small text file for this purpose.
+
+    struct AccTestSummary {
+        std::size_t NumberOfScenarios = 0;
+        std::size_t NumberOfScenariosFailed = 0;
+        std::size_t NumberOfScenariosTerminated = 0;
+        std::size_t NumberOfScenariosCached = 0; // Passed in an earlier run and counted as passed.
+        std::size_t NumberOfScenariosDropped = 0; // Left out of the report, so not counted as passed.
+
+        std::size_t GetNumberOfScenariosPassed() const {
+            return NumberOfScenarios - NumberOfScenariosFailed - NumberOfScenariosTerminated - NumberOfScenariosDropped;
+        }
+
+        AccTestSummary& operator+=(const AccTestSummary& other) {
+            NumberOfScenarios += other.NumberOfScenarios;
+            NumberOfScenariosFailed += other.NumberOfScenariosFailed;
+            NumberOfScenariosTerminated += other.NumberOfScenariosTerminated;
+            NumberOfScenariosCached += other.NumberOfScenariosCached;
+            NumberOfScenariosDropped += other.NumberOfScenariosDropped;
+            return *this;
+        }
+
+        void WriteTo(std::ostream& output) const {
+            output << "scenarios " << NumberOfScenarios << "\n" << "failed " << NumberOfScenariosFailed << "\n" <<
+                    "terminated " << NumberOfScenariosTerminated << "\n";
+            if (NumberOfScenariosCached > 0)
+                output << "cached " << NumberOfScenariosCached << "\n";
+            if (NumberOfScenariosDropped > 0)
+                output << "dropped " << NumberOfScenariosDropped << "\n";
+        }
+
+        bool ReadFrom(std::istream& input) {
+            std::string key;
+            std::size_t value;
+            while (input >> key >> value) {
+                if (key == "scenarios")
+                    NumberOfScenarios = value;
+                else if (key == "failed")
+                    NumberOfScenariosFailed = value;
+                else if (key == "terminated")
+                    NumberOfScenariosTerminated = value;
+                else if (key == "cached")
+                    NumberOfScenariosCached = value;
+                else if (key == "dropped")
+                    NumberOfScenariosDropped = value;
+                else
+                    return false;
+            }
+            return input.eof();
+        }
+    };
+
+    // Default implementation of the test observer that a test suite uses by default. The default observer can be replaced by
+    // a custom implementation using the other overload of the AccTestSuite class or afterwards using the SetTestObserver method.
+    // This default implementation logs all the events, progress, and stats to the output stream provided. The stream is only 
+    // flushed at the end of each scenario and of the suite rather than after every line. SetFailureOnlyOutput cuts the report 
+    // down to the progress and totals plus the full log of whatever failed, and SetStepTimingOutput adds the duration of 
+    // each step to it.
+    // It has also additional methods not inherited from the interface that are used to retrieve test stats after the execution.
+
+    class AccTestObserver : public AccTestObserverIface {
+    public:
+
+        AccTestObserver(std::ostream& outputStream)
+        : m_OutputStream(outputStream) {
+        }
+
+        // With failure-only output, the log of each scenario is kept in memory and only written out for the steps that fail 
+        // and for scenarios that fail or are terminated; the log of a passing step is discarded as soon as it has finished. 
+        // The lines announcing each scenario and summing it up are always written.
+        void SetFailureOnlyOutput(bool failureOnlyOutput) {
+            m_FailureOnlyOutput = failureOnlyOutput;
+        }
+
+        // The phases of every step are timed anyway and added up in the lines summing up each scenario; with step timing 
+        // output they are also written after the tear-down of each step.
+        void SetStepTimingOutput(bool stepTimingOutput) {
+            m_StepTimingOutput = stepTimingOutput;
+        }
+
+        void StartingTestSuite(std::size_t numberOfTestScenarios) override {
+            m_OutputStream << "Starting execution of test suite" << '\n';
+            m_NumberOfScenarios = numberOfTestScenarios;
+            m_CurrentScenarioIndex = m_NumberOfScenariosFailed = m_NumberOfScenariosTerminated = m_NumberOfScenariosCached = 0;
+            m_NumberOfScenariosDropped = 0;
+        }
+
+        void StartingScenario(const std::string& name, const std::string& description, std::size_t numberOfSteps) override {
+            m_NumberOfStepsInScenario = numberOfSteps;
+            ++m_CurrentScenarioIndex;
+            m_CurrentStepIndex = 0;
+            m_OutputStream << '\n' << "  Starting execution of test scenario \"" << name << "\" - " <<
+                    m_CurrentScenarioIndex << " of " << m_NumberOfScenarios <<
+                    " (" << std::setprecision(3) << GetProgressPercentage() << "%)" << '\n' <<
+                    "    Description: " << description << '\n' << "    Total number of steps: " << numberOfSteps << '\n';
+        }
+
+        void StartingScenarioSetup() override {
+            GetLog() << "    Starting scenario setup..." << '\n';
+        }
+
+        void ScenarioTerminated() override {
+            GetLog() << "    A required scenario step failed; scenario execution terminated!" << '\n';
+            WriteBufferedLog();
+            ++m_NumberOfScenariosTerminated;
+        }
+
+        void RunningScenarioTeardown() override {
+            GetLog() << "    Running scenario tear-down..." << '\n';
+        }
+
+        void StartingScenarioStep(const std::string& name, const std::string& description) override {
+            ++m_CurrentStepIndex;
+            m_StepLogStart = m_LogBuffer.GetText().size();
+            GetLog() << "      Starting execution of scenario step \"" << name << "\" - " <<
+                    m_CurrentStepIndex << " of " << m_NumberOfStepsInScenario <<
+                    " (" << std::setprecision(3) << GetProgressPercentage() << "%)" << "\"" << '\n' <<
+                    "      Description: " << description << '\n';
+            m_StepPassed = true;
+        }
+
+        void ExecutingStepSetup() override {
+            GetLog() << "        Running scenario step setup..." << '\n';
+        }
+
+        void RunningStepExpectations() override {
+            GetLog() << "        Running scenario step expectations..." << '\n';
+        }
+
+        void StartingStepAct() override {
+            GetLog() << "        Starting scenario step act..." << '\n';
+        }
+
+        void ExceptionInScenario() override {
+            GetLog() << "      Exception thrown during execution of scenario; terminated!" << '\n';
+            WriteBufferedLog();
+            ++m_NumberOfScenariosTerminated;
+        }
+
+        void ScenarioCrashed(const std::string& reason) override {
+            GetLog() << "      The process running the scenario " << reason << "; terminated!" << '\n';
+            WriteBufferedLog();
+            ++m_NumberOfScenariosTerminated;
+        }
+
+        void ScenarioBranched(std::size_t numberOfBranches) override {
+            if (numberOfBranches > 0)
+                m_NumberOfScenarios += numberOfBranches - 1;
+        }
+
+        void StepTimed(const AccTestStepTiming& timing) override {
+            if (m_StepTimingOutput) {
+                GetLog() << "        Step duration: " << FormatDuration(timing.GetTotal()) << " (setup " <<
+                        FormatDuration(timing.Setup) << ", expectations " << FormatDuration(timing.Expect) << ", act " <<
+                        FormatDuration(timing.Act) << ", verification " << FormatDuration(timing.Verify) << 
+                        ", tear-down " << FormatDuration(timing.Teardown) << ")" << "\n\n";
+            }
+            m_StepPhaseTotals.Setup += timing.Setup;
+            m_StepPhaseTotals.Expect += timing.Expect;
+            m_StepPhaseTotals.Act += timing.Act;
+            m_StepPhaseTotals.Verify += timing.Verify;
+            m_StepPhaseTotals.Teardown += timing.Teardown;
+            if (m_StepPassed)
+                m_LogBuffer.Truncate(m_StepLogStart);
+            else
+                WriteBufferedLog();
+        }
+
+        void ScenarioTimed(const AccTestScenarioTiming& timing) override {
+            m_ScenarioTiming = timing;
+        }
+
+        void StepBenchmarked(const AccTestBenchmarkResult& result) override {
+            GetLog() << "        Benchmark ran " << result.Iterations << " measured iterations after " << 
+                    result.WarmupIterations << " warm-up iterations:" << '\n';
+            GetLog() << "            min " << FormatDuration(result.Min) << ", median " << FormatDuration(result.Median) <<
+                    ", mean " << FormatDuration(result.Mean) << ", p90 " << FormatDuration(result.P90) << ", p99 " << 
+                    FormatDuration(result.P99) << ", max " << FormatDuration(result.Max) << ", stddev " << 
+                    FormatDuration(result.StdDev) << '\n';
+        }
+
+        void ResumedFromCheckpoint(std::size_t numberOfStepsSkipped) override {
+            GetLog() << "    Resuming from the checkpoint after step " << numberOfStepsSkipped <<
+                    "; the steps up to there passed when it was saved." << '\n';
+            m_CurrentStepIndex += numberOfStepsSkipped;
+            m_NumberOfStepsPassed += numberOfStepsSkipped;
+        }
+
+        void ScenarioCached() override {
+            GetLog() << "    Passed in an earlier run of the same test program with the same steps; not run again." << '\n';
+            m_NumberOfStepsPassed = m_NumberOfStepsInScenario;
+            ++m_NumberOfScenariosCached;
+        }
+
+        void ScenariosDropped(std::size_t numberOfScenarios) override {
+            m_NumberOfScenariosDropped += numberOfScenarios;
+        }
+
+        void FlushOutput() override {
+            m_OutputStream.flush();
+        }
+
+        void StepExceptionExpectationNotMet(bool didThrow) override {
+            GetLog() << "        " <<
+                    (didThrow ? "Unexpected exception was thrown!" : "Expected exception was not thrown!") << '\n';
+            m_StepPassed = m_StepPassed && false;
+        }
+
+        void StartingStepVerification() override {
+            GetLog() << "        Starting scenario step verification..." << '\n';
+        }
+
+        void FinishedStepVerification(bool passed) override {
+            GetLog() << "        Scenario step verification " << (passed ? "passed." : "failed!") << '\n';
+            m_StepPassed = m_StepPassed && passed;
+        }
+
+        void StepVerificationFailed(const std::map<int, std::string>& failedCheckOutputs) override {
+            auto& log = GetLog();
+            log << "        Failed step checks:" << '\n';
+            for (const auto& checkOutput : failedCheckOutputs)
+                log << "          Check #" << checkOutput.first << " => " << checkOutput.second << '\n';
+        }
+
+        void StepChecksFailed(const AccTestCheckRecords& failedChecks) override {
+            auto& log = GetLog();
+            log << "        Failed step checks:" << '\n';
+            for (std::size_t index = 0; index < failedChecks.GetSize(); ++index) {
+                log << "          Check #" << failedChecks[index].CheckIndex << " => ";
+                log.write(failedChecks.GetOutputData(index), failedChecks.GetOutputLength(index));
+                if (failedChecks[index].Site.File)
+                    log << " [" << failedChecks[index].Site.File << ":" << failedChecks[index].Site.Line << "]";
+                log << '\n';
+            }
+        }
+
+        void ExecutingStepTeardown() override {
+            GetLog() << "        Running scenario step tear-down..." << (m_StepTimingOutput ? "\n" : "\n\n");
+            if (m_StepPassed)
+                ++m_NumberOfStepsPassed;
+            else
+                ++m_NumberOfStepsFailed;
+        }
+
+        void FinishedScenario() override {
+            if (m_NumberOfStepsPassed == m_NumberOfStepsInScenario)
+                m_LogBuffer.Clear();
+            else
+                WriteBufferedLog();
+            m_OutputStream << "  Finished execution of test scenario." << '\n';
+            if (m_NumberOfStepsPassed == m_NumberOfStepsInScenario)
+                m_OutputStream << "    All steps passed successfully. Total: " << m_NumberOfStepsInScenario << '\n';
+            else {
+                m_OutputStream << "    Number of failed steps: " << m_NumberOfStepsFailed <<
+                        " out of " << m_NumberOfStepsInScenario << '\n';
+                auto omittedSteps = m_NumberOfStepsInScenario - m_NumberOfStepsPassed - m_NumberOfStepsFailed;
+                if (omittedSteps > 0) {
+                    m_OutputStream << "    Number of omitted steps: " << omittedSteps <<
+                            " out of " << m_NumberOfStepsInScenario << '\n';
+                } else
+                    ++m_NumberOfScenariosFailed;
+            }
+            m_OutputStream << "    Scenario duration: " << FormatDuration(m_ScenarioTiming.GetTotal()) << " (setup " <<
+                    FormatDuration(m_ScenarioTiming.Setup) << ", steps " << FormatDuration(m_ScenarioTiming.Steps) <<
+                    ", tear-down " << FormatDuration(m_ScenarioTiming.Teardown) << ")" << '\n';
+            m_OutputStream << "    Total time in step phases: setup " << FormatDuration(m_StepPhaseTotals.Setup) <<
+                    ", expectations " << FormatDuration(m_StepPhaseTotals.Expect) << ", act " <<
+                    FormatDuration(m_StepPhaseTotals.Act) << ", verification " << FormatDuration(m_StepPhaseTotals.Verify) <<
+                    ", tear-down " << FormatDuration(m_StepPhaseTotals.Teardown) << '\n';
+            m_OutputStream << '\n';
+            m_CurrentStepIndex = m_NumberOfStepsInScenario = m_NumberOfStepsPassed = m_NumberOfStepsFailed = 0;
+            m_ScenarioTiming = AccTestScenarioTiming();
+            m_StepPhaseTotals = AccTestStepTiming();
+            m_OutputStream.flush();
+        }
+
+        // The totals are kept after the suite has finished so they can be retrieved using GetSummary and the other getters; 
+        // they are reset when the next suite starts.
+        void FinishedTestSuite() override {
+            PrintSummary(m_OutputStream, GetSummary());
+            m_OutputStream.flush();
+        }
+
+        static void PrintSummary(std::ostream& outputStream, const AccTestSummary& summary) {
+            outputStream << "Finished execution of test suite." << '\n';
+            if (summary.NumberOfScenariosFailed == 0 && summary.NumberOfScenariosTerminated == 0 && 
+                    summary.NumberOfScenariosDropped == 0)
+                outputStream << "  All scenarios completed successfully." << '\n';
+            else {
+                if (summary.NumberOfScenariosFailed > 0)
+                    outputStream << "  Number of failed scenarios: " << summary.NumberOfScenariosFailed <<
+                        " out of " << summary.NumberOfScenarios << '\n';
+                if (summary.NumberOfScenariosTerminated > 0)
+                    outputStream << "  Number of terminated scenarios: " << summary.NumberOfScenariosTerminated <<
+                        " out of " << summary.NumberOfScenarios << '\n';
+            }
+            if (summary.NumberOfScenariosCached > 0)
+                outputStream << "  Number of scenarios passed in an earlier run and not run again: " << 
+                        summary.NumberOfScenariosCached << " out of " << summary.NumberOfScenarios << '\n';
+            if (summary.NumberOfScenariosDropped > 0)
+                outputStream << "  Number of scenarios left out of the report, whose results are unknown: " << 
+                        summary.NumberOfScenariosDropped << " out of " << summary.NumberOfScenarios << '\n';
+        }
+
+        AccTestSummary GetSummary() {
+            AccTestSummary summary;
+            summary.NumberOfScenarios = m_NumberOfScenarios;
+            summary.NumberOfScenariosFailed = m_NumberOfScenariosFailed;
+            summary.NumberOfScenariosTerminated = m_NumberOfScenariosTerminated;
+            summary.NumberOfScenariosCached = m_NumberOfScenariosCached;
+            summary.NumberOfScenariosDropped = m_NumberOfScenariosDropped;
+            return summary;
+        }
+
+        std::size_t GetNumberOfScenariosPassed() {
+            return GetSummary().GetNumberOfScenariosPassed();
+        }
+
+        std::size_t GetNumberOfScenarios() {
+            return m_NumberOfScenarios;
+        }
+
+        static std::string FormatDuration(AccTestClock::duration duration) {
+            std::ostringstream text;
+            text << std::fixed << std::setprecision(3) << std::chrono::duration<double, std::milli>(duration).count() << " ms";
+            return text.str();
+        }
+
+        double GetProgressPercentage() {
+            if (m_NumberOfScenarios == 0 || m_NumberOfStepsInScenario == 0)
+                return 0;
+            auto currentStepIndexNonZero = std::max(m_CurrentStepIndex, static_cast<std::size_t> (1));
+            auto currentScenarioProgress = static_cast<double> (currentStepIndexNonZero - 1) / m_NumberOfStepsInScenario;
+            return (m_CurrentScenarioIndex - 1 + currentScenarioProgress) / m_NumberOfScenarios * 100;
+        }
+    private:
+
+        std::ostream& GetLog() {
+            return m_FailureOnlyOutput ? m_BufferedLog : m_OutputStream;
+        }
+
+        void WriteBufferedLog() {
+            const auto& text = m_LogBuffer.GetText();
+            m_OutputStream.write(text.data(), static_cast<std::streamsize> (text.size()));
+            m_LogBuffer.Clear();
+            m_StepLogStart = 0;
+        }
+
+        std::ostream& m_OutputStream;
+        bool m_FailureOnlyOutput = false;
+        bool m_StepTimingOutput = false;
+        AccTestStringBuffer m_LogBuffer;
+        std::ostream m_BufferedLog {&m_LogBuffer};
+        std::size_t m_StepLogStart = 0;
+        std::size_t m_CurrentScenarioIndex = 0;
+        std::size_t m_NumberOfScenarios = 0;
+        std::size_t m_NumberOfScenariosFailed = 0;
+        std::size_t m_NumberOfScenariosTerminated = 0;
+        std::size_t m_NumberOfScenariosCached = 0;
+        std::size_t m_NumberOfScenariosDropped = 0;
+        std::size_t m_CurrentStepIndex = 0;
+        std::size_t m_NumberOfStepsInScenario = 0;
+        std::size_t m_NumberOfStepsPassed = 0;
+        std::size_t m_NumberOfStepsFailed = 0;
+        bool m_StepPassed = true;
+        AccTestScenarioTiming m_ScenarioTiming;
+        AccTestStepTiming m_StepPhaseTotals;
+    };
+
+    // A ring of bytes that one thread writes text into and another reads back in the same order, without locking. The writer
+    // appends at the end once HasRoomFor tells there is room, and the reader releases what it has read, making room again.
+    // Positions only ever grow and are taken modulo the capacity, so text may wrap around the end of the ring.
+
+    class AccTestTextArena {
+    public:
+
+        explicit AccTestTextArena(std::size_t capacity)
+        : m_Data(new char[capacity]), m_Capacity(capacity) {
+        }
+
+        std::size_t GetCapacity() const {
+            return m_Capacity;
+        }
+
+        bool HasRoomFor(std::size_t size) const {
+            return m_Capacity - (m_End - m_Start.load(std::memory_order_acquire)) >= size;
+        }
+
+        // Reserves size bytes at the end, which must be HasRoomFor, and returns the position of the first one.
+        std::size_t Allocate(std::size_t size) {
+            auto position = m_End;
+            m_End += size;
+            return position;
+        }
+
+        void Write(std::size_t position, const void* data, std::size_t size) {
+            Copy(position, static_cast<char*> (const_cast<void*> (data)), size, true);
+        }
+
+        void Read(std::size_t position, void* data, std::size_t size) {
+            Copy(position, static_cast<char*> (data), size, false);
+        }
+
+        // Called by the reader with the position following the last byte it is done with.
+        void Release(std::size_t end) {
+            m_Start.store(end, std::memory_order_release);
+        }
+
+    private:
+
+        void Copy(std::size_t position, char* data, std::size_t size, bool toArena) {
+            while (size > 0) {
+                auto index = position % m_Capacity;
+                auto length = std::min(size, m_Capacity - index);
+                if (toArena)
+                    std::memcpy(m_Data.get() + index, data, length);
+                else
+                    std::memcpy(data, m_Data.get() + index, length);
+                position += length;
+                data += length;
+                size -= length;
+            }
+        }
+
+        std::unique_ptr<char[]> m_Data;
+        std::size_t m_Capacity;
+        std::size_t m_End = 0;
+        std::atomic<std::size_t> m_Start {0};
+    };
+
+    // The fixed-size form in which AccTestAsyncObserver queues an event. Names and descriptions are replaced by the ids they 
+    // were interned under and the timings are stored in place; the outputs of failed checks and the reasons of crashes are 
+    // copied into the text arena of the reporting thread (see AccTestTextArena), and the record only says where they are. 
+    // Text too large for the arena is kept in a buffer of its own in Text instead, which the reader deletes.
+
+    struct AccTestEventRecord {
+
+        AccTestEventRecord(AccTestEventType type = AccTestEventType::FinishedScenario)
+        : Type(type) {
+        }
+
+        union Timings {
+
+            Timings()
+            : Step() {
+            }
+
+            AccTestStepTiming Step;
+            AccTestScenarioTiming Scenario;
+            AccTestBenchmarkResult Benchmark;
+        };
+
+        AccTestEventType Type;
+        bool Flag = false;
+        std::size_t Count = 0;
+        std::size_t NameId = 0;
+        std::size_t DescriptionId = 0;
+        Timings Timing;
+        AccTestTextArena* TextArena = nullptr;
+        char* Text = nullptr;
+        std::size_t TextOffset = 0;
+        std::size_t TextSize = 0;
+    };
+
+    // A bounded queue of event records that any number of threads can push to and a single thread pops from without taking 
+    // a lock (the array-based queue of Dmitry Vyukov). Each slot carries a sequence number telling whether it is free for the
+    // push with the same position or holds the record for the pop at that position. Capacity is rounded up to a power of two.
+
+    class AccTestEventQueue {
+    public:
+
+        AccTestEventQueue(std::size_t capacity) {
+            m_Capacity = 1;
+            while (m_Capacity < capacity)
+                m_Capacity *= 2;
+            m_Slots.reset(new Slot[m_Capacity]);
+            for (std::size_t position = 0; position < m_Capacity; ++position)
+                m_Slots[position].Sequence.store(position, std::memory_order_relaxed);
+        }
+
+        std::size_t GetCapacity() const {
+            return m_Capacity;
+        }
+
+        bool TryPush(const AccTestEventRecord& record) {
+            auto position = m_PushPosition.load(std::memory_order_relaxed);
+            for (;;) {
+                auto& slot = m_Slots[position & (m_Capacity - 1)];
+                auto sequence = slot.Sequence.load(std::memory_order_acquire);
+                auto difference = static_cast<std::ptrdiff_t> (sequence) - static_cast<std::ptrdiff_t> (position);
+                if (difference == 0) {
+                    if (m_PushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        slot.Record = record;
+                        slot.Sequence.store(position + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (difference < 0)
+                    return false;
+                else
+                    position = m_PushPosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        // Only for the thread popping.
+        bool TryPop(AccTestEventRecord& record) {
+            auto& slot = m_Slots[m_PopPosition & (m_Capacity - 1)];
+            if (slot.Sequence.load(std::memory_order_acquire) != m_PopPosition + 1)
+                return false;
+            record = slot.Record;
+            slot.Sequence.store(m_PopPosition + m_Capacity, std::memory_order_release);
+            ++m_PopPosition;
+            return true;
+        }
+
+        // Only for the thread popping.
+        bool IsEmpty() const {
+            return m_Slots[m_PopPosition & (m_Capacity - 1)].Sequence.load(std::memory_order_acquire) != m_PopPosition + 1;
+        }
+
+    private:
+
+        struct Slot {
+            std::atomic<std::size_t> Sequence;
+            AccTestEventRecord Record;
+        };
+
+        std::size_t m_Capacity;
+        std::unique_ptr<Slot[]> m_Slots;
+        std::atomic<std::size_t> m_PushPosition {0};
+        std::size_t m_PopPosition = 0;
+    };
+
+    // What AccTestAsyncObserver does while its queue is full: Block waits for the writer thread to make room. DropEvents 
+    // leaves out whole scenarios: a scenario whose StartingScenario finds the queue full is dropped with all of its events,
+    // and the number of scenarios dropped is reported through ScenariosDropped before FinishedTestSuite. The events of the
+    // scenarios already queued in part, and the events outside scenarios, still wait for room, so no observer ever sees a 
+    // scenario with events missing.
+
+    enum class AccTestBackpressurePolicy {
+        Block, DropEvents
+    };
+
+    // Moves the work of an observer, typically the formatting and writing of AccTestObserver, off the threads running the 
+    // scenarios. Each event is pushed to a bounded AccTestEventQueue as a fixed-size AccTestEventRecord, so reporting an 
+    // event allocates nothing once its name has been seen: names and descriptions are interned in a table shared by all the
+    // threads, which only takes a lock for the events naming a scenario or step, and the text of failed checks and crashes 
+    // goes into an AccTestTextArena of the reporting thread (textCapacity bytes, allocated on the first such event). A 
+    // background thread pops whatever has been queued as one batch, turns the records back into events, replays them into
+    // the wrapped observer, and calls its FlushOutput once per batch. The threads only ever wait on condition variables: the
+    // writer for events, the threads reporting events for room in the queue or their arena, and Flush for the writer.
+    // Memory is bounded by the capacity of the queue, the arenas, and the interned names; what happens when the queue fills
+    // up is decided by the backpressure policy. Like AccTestObserver, it expects the events of a scenario to arrive as an 
+    // uninterrupted sequence, which the suites make sure of. FinishedTestSuite waits until the wrapped observer has received
+    // every event, so its results are complete as soon as the suite has finished; call Flush to wait at any other time. The
+    // wrapped observer is only ever called from the background thread. The first exception it throws, e.g. because writing 
+    // the report failed, is kept and thrown again from Flush and therefore from FinishedTestSuite; the events after it are 
+    // still passed on.
+
+    class AccTestAsyncObserver : public AccTestEventRecorder {
+    public:
+
+        AccTestAsyncObserver(const std::shared_ptr<AccTestObserverIface>& observer, std::size_t queueCapacity = 4096,
+                AccTestBackpressurePolicy policy = AccTestBackpressurePolicy::Block, std::size_t textCapacity = 1 << 20)
+        : m_Observer(observer), m_Queue(queueCapacity), m_Policy(policy), m_TextCapacity(textCapacity), m_Strings(1) {
+            m_Writer = std::thread(&AccTestAsyncObserver::WriteEvents, this);
+        }
+
+        ~AccTestAsyncObserver() {
+            WaitForWriter();
+            m_Stopping = true;
+            {
+                std::lock_guard<std::mutex> lock(m_WaitMutex);
+                m_EventsQueued.notify_one();
+            }
+            m_Writer.join();
+        }
+
+        // Waits until the wrapped observer has received every event queued so far and throws the exception it threw, if any.
+        void Flush() {
+            WaitForWriter();
+            std::exception_ptr exception;
+            {
+                std::lock_guard<std::mutex> lock(m_ExceptionMutex);
+                std::swap(exception, m_Exception);
+            }
+            if (exception)
+                std::rethrow_exception(exception);
+        }
+
+        std::size_t GetNumberOfDroppedScenarios() const {
+            return m_NumberOfDroppedScenarios.load();
+        }
+
+        void StartingScenario(const std::string& name, const std::string& description, std::size_t numberOfSteps) override {
+            AccTestEventRecord record(AccTestEventType::StartingScenario);
+            record.NameId = Intern(name);
+            record.DescriptionId = Intern(description);
+            record.Count = numberOfSteps;
+            Push(record);
+        }
+
+        void StartingScenarioStep(const std::string& name, const std::string& description) override {
+            if (IsInDroppedScenario(AccTestEventType::StartingScenarioStep))
+                return;
+            AccTestEventRecord record(AccTestEventType::StartingScenarioStep);
+            record.NameId = Intern(name);
+            record.DescriptionId = Intern(description);
+            Push(record);
+        }
+
+        void ScenarioCrashed(const std::string& reason) override {
+            if (IsInDroppedScenario(AccTestEventType::ScenarioCrashed))
+                return;
+            AccTestEventRecord record(AccTestEventType::ScenarioCrashed);
+            auto text = AllocateText(record, reason.size());
+            text.Write(reason.data(), reason.size());
+            Push(record);
+        }
+
+        void StepVerificationFailed(const std::map<int, std::string>& failedCheckOutputs) override {
+            if (IsInDroppedScenario(AccTestEventType::StepVerificationFailed))
+                return;
+            AccTestEventRecord record(AccTestEventType::StepVerificationFailed);
+            auto size = sizeof(std::size_t);
+            for (const auto& checkOutput : failedCheckOutputs)
+                size += sizeof(int) + sizeof(std::size_t) + checkOutput.second.size();
+            auto text = AllocateText(record, size);
+            text.WriteValue(failedCheckOutputs.size());
+            for (const auto& checkOutput : failedCheckOutputs) {
+                text.WriteValue(checkOutput.first);
+                text.WriteValue(checkOutput.second.size());
+                text.Write(checkOutput.second.data(), checkOutput.second.size());
+            }
+            Push(record);
+        }
+
+        void StepChecksFailed(const AccTestCheckRecords& failedChecks) override {
+            if (IsInDroppedScenario(AccTestEventType::StepChecksFailed))
+                return;
+            AccTestEventRecord record(AccTestEventType::StepChecksFailed);
+            const auto& records = failedChecks.GetRecords();
+            const auto& output = failedChecks.GetOutput();
+            auto recordsSize = records.size() * sizeof(AccTestCheckRecord);
+            auto text = AllocateText(record, sizeof(std::size_t) + recordsSize + output.size());
+            text.WriteValue(records.size());
+            text.Write(records.data(), recordsSize);
+            text.Write(output.data(), output.size());
+            Push(record);
+        }
+
+    protected:
+
+        // The events carrying strings have callbacks of their own above, so the events recorded here only have fixed-size 
+        // fields.
+        void Record(const AccTestEvent& event) override {
+            if (IsInDroppedScenario(event.Type))
+                return;
+            if (event.Type == AccTestEventType::FinishedTestSuite && m_NumberOfDroppedScenariosToReport > 0) {
+                AccTestEventRecord dropped(AccTestEventType::ScenariosDropped);
+                dropped.Count = m_NumberOfDroppedScenariosToReport;
+                m_NumberOfDroppedScenariosToReport = 0;
+                Push(dropped);
+            }
+            AccTestEventRecord record(event.Type);
+            record.Count = event.Count;
+            record.Flag = event.Flag;
+            if (event.Type == AccTestEventType::StepTimed)
+                record.Timing.Step = event.StepTiming;
+            else if (event.Type == AccTestEventType::ScenarioTimed)
+                record.Timing.Scenario = event.ScenarioTiming;
+            else if (event.Type == AccTestEventType::StepBenchmarked)
+                record.Timing.Benchmark = event.BenchmarkResult;
+            Push(record);
+            if (event.Type == AccTestEventType::FinishedTestSuite)
+                Flush();
+        }
+
+    private:
+
+        // Where the text of a record is written to or read from: the text arena of the reporting thread, or the buffer of 
+        // its own the record got because the text was too large for the arena.
+        class TextCursor {
+        public:
+
+            TextCursor(const AccTestEventRecord& record)
+            : m_Arena(record.TextArena), m_Buffer(record.Text), m_Position(record.TextOffset) {
+            }
+
+            void Write(const void* data, std::size_t size) {
+                if (size == 0)
+                    return;
+                if (m_Buffer)
+                    std::memcpy(m_Buffer + m_Position, data, size);
+                else
+                    m_Arena->Write(m_Position, data, size);
+                m_Position += size;
+            }
+
+            void Read(void* data, std::size_t size) {
+                if (size == 0)
+                    return;
+                if (m_Buffer)
+                    std::memcpy(data, m_Buffer + m_Position, size);
+                else
+                    m_Arena->Read(m_Position, data, size);
+                m_Position += size;
+            }
+
+            template <typename T>
+            void WriteValue(const T& value) {
+                Write(&value, sizeof(value));
+            }
+
+            template <typename T>
+            T ReadValue() {
+                T value;
+                Read(&value, sizeof(value));
+                return value;
+            }
+
+        private:
+            AccTestTextArena* m_Arena;
+            char* m_Buffer;
+            std::size_t m_Position;
+        };
+
+        // Tells whether the event belongs to a scenario DropEvents is leaving out, which ends with its FinishedScenario.
+        bool IsInDroppedScenario(AccTestEventType type) {
+            if (!m_DroppingScenario)
+                return false;
+            auto isSuiteEvent = type == AccTestEventType::StartingTestSuite || type == AccTestEventType::FinishedTestSuite;
+            if (type == AccTestEventType::FinishedScenario || isSuiteEvent)
+                m_DroppingScenario = false;
+            return !isSuiteEvent;
+        }
+
+        std::size_t Intern(const std::string& text) {
+            if (text.empty())
+                return 0;
+            std::lock_guard<std::mutex> lock(m_StringsMutex);
+            auto string = m_StringIds.find(text);
+            if (string != m_StringIds.end())
+                return string->second;
+            m_Strings.push_back(text);
+            return m_StringIds[text] = m_Strings.size() - 1;
+        }
+
+        TextCursor AllocateText(AccTestEventRecord& record, std::size_t size) {
+            record.TextSize = size;
+            if (size > m_TextCapacity) {
+                record.Text = new char[size];
+                return TextCursor(record);
+            }
+            AccTestTextArena* arena;
+            {
+                std::lock_guard<std::mutex> lock(m_TextArenasMutex);
+                auto& threadArena = m_TextArenas[std::this_thread::get_id()];
+                if (!threadArena)
+                    threadArena.reset(new AccTestTextArena(m_TextCapacity));
+                arena = threadArena.get();
+            }
+            if (!arena->HasRoomFor(size))
+                WaitForWriterProgress([arena, size]() { return arena->HasRoomFor(size); });
+            record.TextArena = arena;
+            record.TextOffset = arena->Allocate(size);
+            return TextCursor(record);
+        }
+
+        void Push(const AccTestEventRecord& record) {
+            if (!m_Queue.TryPush(record)) {
+                if (record.Type == AccTestEventType::StartingScenario && m_Policy == AccTestBackpressurePolicy::DropEvents) {
+                    m_DroppingScenario = true;
+                    ++m_NumberOfDroppedScenarios;
+                    ++m_NumberOfDroppedScenariosToReport;
+                    return;
+                }
+                WaitForWriterProgress([this, &record]() { return m_Queue.TryPush(record); });
+            }
+            ++m_NumberOfEventsQueued;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (m_WriterWaiting.load()) {
+                std::lock_guard<std::mutex> lock(m_WaitMutex);
+                m_EventsQueued.notify_one();
+            }
+        }
+
+        // Blocks the calling thread until the writer has made enough progress for the condition to hold. The writer only 
+        // takes the lock to notify when it sees a thread waiting; the fences make sure it can't miss one that is about to.
+        template <typename Condition>
+        void WaitForWriterProgress(const Condition& condition) {
+            std::unique_lock<std::mutex> lock(m_WaitMutex);
+            ++m_NumberOfWaitingThreads;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            m_WriterProgress.wait(lock, condition);
+            --m_NumberOfWaitingThreads;
+        }
+
+        void WaitForWriter() {
+            auto numberOfEventsQueued = m_NumberOfEventsQueued.load();
+            if (m_NumberOfEventsWritten.load() < numberOfEventsQueued)
+                WaitForWriterProgress([this, numberOfEventsQueued]() { 
+                    return m_NumberOfEventsWritten.load() >= numberOfEventsQueued; 
+                });
+        }
+
+        void NotifyWaitingThreads() {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (m_NumberOfWaitingThreads.load() > 0) {
+                std::lock_guard<std::mutex> lock(m_WaitMutex);
+                m_WriterProgress.notify_all();
+            }
+        }
+
+        void WriteEvents() {
+            std::vector<AccTestEventRecord> batch;
+            batch.reserve(m_Queue.GetCapacity());
+            AccTestEventRecord record;
+            for (;;) {
+                while (batch.size() < m_Queue.GetCapacity() && m_Queue.TryPop(record))
+                    batch.push_back(record);
+                if (batch.empty()) {
+                    if (m_Stopping)
+                        return;
+                    std::unique_lock<std::mutex> lock(m_WaitMutex);
+                    m_WriterWaiting = true;
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    m_EventsQueued.wait(lock, [this]() { return m_Stopping || !m_Queue.IsEmpty(); });
+                    m_WriterWaiting = false;
+                    continue;
+                }
+                NotifyWaitingThreads();
+                for (const auto& queuedRecord : batch) {
+                    try {
+                        ReplayEvent(ToEvent(queuedRecord), *m_Observer);
+                    } catch (...) {
+                        KeepException();
+                    }
+                }
+                try {
+                    m_Observer->FlushOutput();
+                } catch (...) {
+                    KeepException();
+                }
+                m_NumberOfEventsWritten += batch.size();
+                batch.clear();
+                NotifyWaitingThreads();
+            }
+        }
+
+        // Turns the record back into an event, reusing the strings and containers of the previous one, and releases its text.
+        const AccTestEvent& ToEvent(const AccTestEventRecord& record) {
+            auto& event = m_Event;
+            event.Type = record.Type;
+            event.Count = record.Count;
+            event.Flag = record.Flag;
+            if (record.Type == AccTestEventType::StartingScenario || record.Type == AccTestEventType::StartingScenarioStep) {
+                std::lock_guard<std::mutex> lock(m_StringsMutex);
+                event.Name = m_Strings[record.NameId];
+                event.Description = m_Strings[record.DescriptionId];
+            }
+            TextCursor text(record);
+            switch (record.Type) {
+                case AccTestEventType::StepTimed: event.StepTiming = record.Timing.Step; break;
+                case AccTestEventType::ScenarioTimed: event.ScenarioTiming = record.Timing.Scenario; break;
+                case AccTestEventType::StepBenchmarked: event.BenchmarkResult = record.Timing.Benchmark; break;
+                case AccTestEventType::ScenarioCrashed:
+                    event.Description.resize(record.TextSize);
+                    text.Read(&event.Description[0], record.TextSize);
+                    break;
+                case AccTestEventType::StepVerificationFailed:
+                    event.CheckOutputs.clear();
+                    for (auto count = text.ReadValue<std::size_t>(); count > 0; --count) {
+                        auto index = text.ReadValue<int>();
+                        auto& output = event.CheckOutputs[index];
+                        output.resize(text.ReadValue<std::size_t>());
+                        text.Read(&output[0], output.size());
+                    }
+                    break;
+                case AccTestEventType::StepChecksFailed:
+                    event.CheckRecords.resize(text.ReadValue<std::size_t>());
+                    text.Read(event.CheckRecords.data(), event.CheckRecords.size() * sizeof(AccTestCheckRecord));
+                    event.CheckOutput.resize(record.TextSize - sizeof(std::size_t) - 
+                            event.CheckRecords.size() * sizeof(AccTestCheckRecord));
+                    text.Read(&event.CheckOutput[0], event.CheckOutput.size());
+                    break;
+                default:
+                    break;
+            }
+            if (record.TextArena)
+                record.TextArena->Release(record.TextOffset + record.TextSize);
+            delete[] record.Text;
+            return event;
+        }
+
+        void KeepException() {
+            std::lock_guard<std::mutex> lock(m_ExceptionMutex);
+            if (!m_Exception)
+                m_Exception = std::current_exception();
+        }
+
+        std::shared_ptr<AccTestObserverIface> m_Observer;
+        AccTestEventQueue m_Queue;
+        AccTestBackpressurePolicy m_Policy;
+        std::size_t m_TextCapacity;
+        std::mutex m_StringsMutex;
+        std::deque<std::string> m_Strings;
+        std::map<std::string, std::size_t> m_StringIds;
+        std::mutex m_TextArenasMutex;
+        std::map<std::thread::id, std::unique_ptr<AccTestTextArena> > m_TextArenas;
+        bool m_DroppingScenario = false;
+        std::size_t m_NumberOfDroppedScenariosToReport = 0;
+        std::atomic<std::size_t> m_NumberOfDroppedScenarios {0};
+        std::atomic<std::size_t> m_NumberOfEventsQueued {0};
+        std::atomic<std::size_t> m_NumberOfEventsWritten {0};
+        std::atomic<bool> m_Stopping {false};
+        std::mutex m_WaitMutex;
+        std::condition_variable m_EventsQueued;
+        std::condition_variable m_WriterProgress;
+        std::atomic<bool> m_WriterWaiting {false};
+        std::atomic<std::size_t> m_NumberOfWaitingThreads {0};
+        std::mutex m_ExceptionMutex;
+        std::exception_ptr m_Exception;
+        AccTestEvent m_Event;
+        std::thread m_Writer;
+    };
+
+    // Hands every event to each of a group of observers in the order they were added, e.g. to write a log file while 
+    // AccTestObserver keeps the totals.
+
+    class AccTestObserverGroup : public AccTestEventRecorder {
+    public:
+
+        void Add(const std::shared_ptr<AccTestObserverIface>& observer) {
+            m_Observers.push_back(observer);
+        }
+
+        void FlushOutput() override {
+            for (const auto& observer : m_Observers)
+                observer->FlushOutput();
+        }
+
+    protected:
+
+        void Record(const AccTestEvent& event) override {
+            for (const auto& observer : m_Observers)
+                ReplayEvent(event, *observer);
+        }
+
+    private:
+        std::vector<std::shared_ptr<AccTestObserverIface> > m_Observers;
+    };
+
+    // Tells whether the scenarios reported to it passed, i.e. none of their steps failed and none of them was terminated, 
+    // all together and by scenario name.
+
+    class AccTestVerdictObserver : public AccTestEventRecorder {
+    public:
+
+        bool HasPassed() const {
+            return m_Passed;
+        }
+
+        const std::map<std::string, bool>& GetScenarioVerdicts() const {
+            return m_ScenarioVerdicts;
+        }
+
+    protected:
+
+        void Record(const AccTestEvent& event) override {
+            switch (event.Type) {
+                case AccTestEventType::StartingScenario:
+                    m_CurrentScenario = m_ScenarioVerdicts.insert(std::make_pair(event.Name, true)).first;
+                    break;
+                case AccTestEventType::FinishedStepVerification:
+                    if (!event.Flag)
+                        Fail();
+                    break;
+                case AccTestEventType::StepExceptionExpectationNotMet:
+                case AccTestEventType::ScenarioTerminated:
+                case AccTestEventType::ExceptionInScenario:
+                case AccTestEventType::ScenarioCrashed:
+                    Fail();
+                    break;
+                default:
+                    break;
+            }
+        }
+
+    private:
+
+        void Fail() {
+            m_Passed = false;
+            if (m_CurrentScenario != m_ScenarioVerdicts.end())
+                m_CurrentScenario->second = false;
+        }
+
+        bool m_Passed = true;
+        std::map<std::string, bool> m_ScenarioVerdicts;
+        std::map<std::string, bool>::iterator m_CurrentScenario = m_ScenarioVerdicts.end();
+    };
+
+    // The compact binary log written by AccTestBinaryLogObserver and read by AccTestBinaryLogReader. The file starts with 
+    // the eight bytes "ProTestL" followed by records, each starting with a varint (LEB128) tag:
+    //   0 defines a string: its number, then its length and its bytes. Strings are numbered from 0 in order of definition 
+    //     and each is defined once, right before the first record using it.
+    //   Any other tag is an event of type tag - 1 (see AccTestEventType), followed by the nanoseconds passed since the 
+    //     previous event, a bit mask of the fields present, and the fields themselves. Names, descriptions, and the file and 
+    //     expression texts of check sites are string numbers; durations and other signed numbers are zigzag varints.
+    // When the suite finishes, an index is appended that can be used straight from a memory mapped file: the table of 
+    // strings (offset and length of the bytes of each, two fixed 8 byte integers), the table of scenarios (ScenarioEntry, 
+    // six fixed 8 byte integers each), and a trailer of four 8 byte integers (offset and size of the string table, offset and 
+    // size of the scenario table) followed by the eight bytes "ProTestI". All fixed integers are little endian. A log without
+    // the index, e.g. of a run that was killed, can still be read from the start.
+
+    class AccTestBinaryLog {
+    public:
+        enum ScenarioStatus {
+            Passed, Failed, Terminated
+        };
+
+        // Where the records of a scenario start and end, the number of its name, how it ended, and when it started and ended
+        // in nanoseconds since the log was started. The times are those measured by the scenario (see ScenarioTimed), which 
+        // differ from the times its events were written when scenarios run concurrently.
+        struct ScenarioEntry {
+            unsigned long long Offset;
+            unsigned long long End;
+            unsigned long long NameId;
+            unsigned long long Status;
+            unsigned long long StartTime;
+            unsigned long long EndTime;
+        };
+
+        enum FieldMask {
+            HasName = 1, HasDescription = 2, HasCount = 4, HasFlag = 8, HasCheckOutputs = 16, HasCheckRecords = 32, 
+            HasStepTiming = 64, HasScenarioTiming = 128, HasBenchmarkResult = 256
+        };
+
+        static const std::size_t MagicSize = 8;
+        static const std::size_t TrailerSize = 5 * 8;
+
+        static const char* GetMagic() {
+            return "ProTestL";
+        }
+
+        static const char* GetIndexMagic() {
+            return "ProTestI";
+        }
+
+        static void WriteVarint(unsigned long long value, std::string& buffer) {
+            while (value >= 0x80) {
+                buffer.push_back(static_cast<char> ((value & 0x7f) | 0x80));
+                value >>= 7;
+            }
+            buffer.push_back(static_cast<char> (value));
+        }
+
+        static bool ReadVarint(const char* data, std::size_t size, std::size_t& position, unsigned long long& value) {
+            value = 0;
+            for (int shift = 0; position < size && shift < 64; shift += 7) {
+                auto byte = static_cast<unsigned char> (data[position++]);
+                value |= static_cast<unsigned long long> (byte & 0x7f) << shift;
+                if (!(byte & 0x80))
+                    return true;
+            }
+            return false;
+        }
+
+        static void WriteSigned(long long value, std::string& buffer) {
+            WriteVarint((static_cast<unsigned long long> (value) << 1) ^ static_cast<unsigned long long> (value >> 63), buffer);
+        }
+
+        static bool ReadSigned(const char* data, std::size_t size, std::size_t& position, long long& value) {
+            unsigned long long encoded;
+            if (!ReadVarint(data, size, position, encoded))
+                return false;
+            value = static_cast<long long> (encoded >> 1) ^ -static_cast<long long> (encoded & 1);
+            return true;
+        }
+
+        static void WriteFixed(unsigned long long value, std::string& buffer) {
+            for (int byte = 0; byte < 8; ++byte)
+                buffer.push_back(static_cast<char> ((value >> (8 * byte)) & 0xff));
+        }
+
+        static unsigned long long ReadFixed(const char* data) {
+            unsigned long long value = 0;
+            for (int byte = 0; byte < 8; ++byte)
+                value |= static_cast<unsigned long long> (static_cast<unsigned char> (data[byte])) << (8 * byte);
+            return value;
+        }
+
+        static long long ToNanoseconds(AccTestClock::duration duration) {
+            return static_cast<long long> (std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+        }
+
+        static AccTestClock::duration FromNanoseconds(long long nanoseconds) {
+            return std::chrono::duration_cast<AccTestClock::duration>(std::chrono::nanoseconds(nanoseconds));
+        }
+    };
+
+    // Writes the events to a stream in the format of AccTestBinaryLog. The records are collected in memory and written out 
+    // at the end of every scenario, and the index is written when the suite finishes. One log holds a single run of a suite.
+
+    class AccTestBinaryLogObserver : public AccTestEventRecorder {
+    public:
+
+        AccTestBinaryLogObserver(std::ostream& outputStream)
+        : m_OutputStream(outputStream), m_StartTime(AccTestClock::now()), m_LastEventTime(m_StartTime) {
+            m_Buffer.append(AccTestBinaryLog::GetMagic(), AccTestBinaryLog::MagicSize);
+        }
+
+    protected:
+
+        void Record(const AccTestEvent& event) override {
+            typedef AccTestBinaryLog Log;
+            std::string fields;
+            unsigned long long mask = 0;
+            if (!event.Name.empty()) {
+                mask |= Log::HasName;
+                Log::WriteVarint(Intern(event.Name), fields);
+            }
+            if (!event.Description.empty()) {
+                mask |= Log::HasDescription;
+                Log::WriteVarint(Intern(event.Description), fields);
+            }
+            if (event.Count != 0) {
+                mask |= Log::HasCount;
+                Log::WriteVarint(event.Count, fields);
+            }
+            if (event.Flag)
+                mask |= Log::HasFlag;
+            if (!event.CheckOutputs.empty()) {
+                mask |= Log::HasCheckOutputs;
+                Log::WriteVarint(event.CheckOutputs.size(), fields);
+                for (const auto& checkOutput : event.CheckOutputs) {
+                    Log::WriteVarint(static_cast<unsigned long long> (checkOutput.first), fields);
+                    WriteBytes(checkOutput.second, fields);
+                }
+            }
+            if (event.Type == AccTestEventType::StepChecksFailed) {
+                mask |= Log::HasCheckRecords;
+                Log::WriteVarint(event.CheckRecords.size(), fields);
+                for (const auto& record : event.CheckRecords) {
+                    Log::WriteVarint(static_cast<unsigned long long> (record.CheckIndex), fields);
+                    Log::WriteVarint(record.Site.File ? Intern(record.Site.File) + 1 : 0, fields);
+                    Log::WriteVarint(static_cast<unsigned long long> (record.Site.Line), fields);
+                    Log::WriteVarint(record.Site.Expression ? Intern(record.Site.Expression) + 1 : 0, fields);
+                    Log::WriteVarint(record.OutputStart, fields);
+                }
+                WriteBytes(event.CheckOutput, fields);
+            }
+            if (event.Type == AccTestEventType::StepTimed) {
+                mask |= Log::HasStepTiming;
+                const auto& timing = event.StepTiming;
+                Log::WriteSigned(Log::ToNanoseconds(timing.Start - m_StartTime), fields);
+                for (auto phase : {timing.Setup, timing.Expect, timing.Act, timing.Verify, timing.Teardown})
+                    Log::WriteSigned(Log::ToNanoseconds(phase), fields);
+            }
+            if (event.Type == AccTestEventType::ScenarioTimed) {
+                mask |= Log::HasScenarioTiming;
+                const auto& timing = event.ScenarioTiming;
+                Log::WriteSigned(Log::ToNanoseconds(timing.Start - m_StartTime), fields);
+                for (auto phase : {timing.Setup, timing.Steps, timing.Teardown})
+                    Log::WriteSigned(Log::ToNanoseconds(phase), fields);
+            }
+            if (event.Type == AccTestEventType::StepBenchmarked) {
+                mask |= Log::HasBenchmarkResult;
+                const auto& result = event.BenchmarkResult;
+                Log::WriteVarint(result.WarmupIterations, fields);
+                Log::WriteVarint(result.Iterations, fields);
+                for (auto statistic : {result.Min, result.Median, result.Mean, result.P90, result.P99, result.Max, result.StdDev})
+                    Log::WriteSigned(Log::ToNanoseconds(statistic), fields);
+            }
+
+            auto now = AccTestClock::now();
+            auto time = static_cast<unsigned long long> (Log::ToNanoseconds(now - m_StartTime));
+            if (event.Type == AccTestEventType::StartingScenario) {
+                m_CurrentScenario.Offset = GetOffset();
+                m_CurrentScenario.NameId = Intern(event.Name);
+                m_CurrentScenario.Status = Log::Passed;
+                m_CurrentScenario.StartTime = time;
+                m_CurrentScenario.EndTime = 0;
+            }
+            Log::WriteVarint(static_cast<unsigned long long> (event.Type) + 1, m_Buffer);
+            Log::WriteVarint(static_cast<unsigned long long> (Log::ToNanoseconds(now - m_LastEventTime)), m_Buffer);
+            Log::WriteVarint(mask, m_Buffer);
+            m_Buffer += fields;
+            m_LastEventTime = now;
+            UpdateScenarioStatus(event);
+            if (event.Type == AccTestEventType::ScenarioTimed) {
+                m_CurrentScenario.StartTime = static_cast<unsigned long long> (
+                        Log::ToNanoseconds(event.ScenarioTiming.Start - m_StartTime));
+                m_CurrentScenario.EndTime = m_CurrentScenario.StartTime + 
+                        static_cast<unsigned long long> (Log::ToNanoseconds(event.ScenarioTiming.GetTotal()));
+            }
+            if (event.Type == AccTestEventType::FinishedScenario) {
+                m_CurrentScenario.End = GetOffset();
+                if (m_CurrentScenario.EndTime < m_CurrentScenario.StartTime)
+                    m_CurrentScenario.EndTime = time;
+                m_Scenarios.push_back(m_CurrentScenario);
+                Flush();
+            } else if (event.Type == AccTestEventType::FinishedTestSuite) {
+                WriteIndex();
+                Flush();
+            }
+        }
+
+    private:
+
+        unsigned long long Intern(const std::string& text) {
+            auto string = m_StringIds.find(text);
+            if (string != m_StringIds.end())
+                return string->second;
+            auto id = static_cast<unsigned long long> (m_Strings.size());
+            AccTestBinaryLog::WriteVarint(0, m_Buffer);
+            AccTestBinaryLog::WriteVarint(id, m_Buffer);
+            AccTestBinaryLog::WriteVarint(text.size(), m_Buffer);
+            m_Strings.push_back(std::make_pair(GetOffset(), static_cast<unsigned long long> (text.size())));
+            m_Buffer += text;
+            m_StringIds[text] = id;
+            return id;
+        }
+
+        static void WriteBytes(const std::string& bytes, std::string& buffer) {
+            AccTestBinaryLog::WriteVarint(bytes.size(), buffer);
+            buffer += bytes;
+        }
+
+        void UpdateScenarioStatus(const AccTestEvent& event) {
+            auto& status = m_CurrentScenario.Status;
+            switch (event.Type) {
+                case AccTestEventType::FinishedStepVerification:
+                    if (!event.Flag && status == AccTestBinaryLog::Passed)
+                        status = AccTestBinaryLog::Failed;
+                    break;
+                case AccTestEventType::StepExceptionExpectationNotMet:
+                    if (status == AccTestBinaryLog::Passed)
+                        status = AccTestBinaryLog::Failed;
+                    break;
+                case AccTestEventType::ScenarioTerminated:
+                case AccTestEventType::ExceptionInScenario:
+                case AccTestEventType::ScenarioCrashed:
+                    status = AccTestBinaryLog::Terminated;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        void WriteIndex() {
+            auto stringTableOffset = GetOffset();
+            for (const auto& string : m_Strings) {
+                AccTestBinaryLog::WriteFixed(string.first, m_Buffer);
+                AccTestBinaryLog::WriteFixed(string.second, m_Buffer);
+            }
+            auto scenarioTableOffset = GetOffset();
+            for (const auto& scenario : m_Scenarios) {
+                for (auto field : {scenario.Offset, scenario.End, scenario.NameId, scenario.Status, scenario.StartTime, 
+                        scenario.EndTime})
+                    AccTestBinaryLog::WriteFixed(field, m_Buffer);
+            }
+            AccTestBinaryLog::WriteFixed(stringTableOffset, m_Buffer);
+            AccTestBinaryLog::WriteFixed(m_Strings.size(), m_Buffer);
+            AccTestBinaryLog::WriteFixed(scenarioTableOffset, m_Buffer);
+            AccTestBinaryLog::WriteFixed(m_Scenarios.size(), m_Buffer);
+            m_Buffer.append(AccTestBinaryLog::GetIndexMagic(), AccTestBinaryLog::MagicSize);
+        }
+
+        unsigned long long GetOffset() {
+            return m_FlushedSize + m_Buffer.size();
+        }
+
+        void Flush() {
+            m_OutputStream.write(m_Buffer.data(), static_cast<std::streamsize> (m_Buffer.size()));
+            m_OutputStream.flush();
+            m_FlushedSize += m_Buffer.size();
+            m_Buffer.clear();
+        }
+
+        std::ostream& m_OutputStream;
+        AccTestClock::time_point m_StartTime;
+        AccTestClock::time_point m_LastEventTime;
+        std::string m_Buffer;
+        unsigned long long m_FlushedSize = 0;
+        std::map<std::string, unsigned long long> m_StringIds;
+        std::vector<std::pair<unsigned long long, unsigned long long> > m_Strings;
+        std::vector<AccTestBinaryLog::ScenarioEntry> m_Scenarios;
+        AccTestBinaryLog::ScenarioEntry m_CurrentScenario = AccTestBinaryLog::ScenarioEntry();
+    };
+
+    // Reads a log written by AccTestBinaryLogObserver from memory, e.g. a memory mapped file, without copying it. If the log
+    // has an index, the scenarios can be looked up and replayed one by one without reading anything else; otherwise only 
+    // Replay is available, which reads the log from the start. The points in time of the replayed timings are relative to 
+    // the start of the log.
+
+    class AccTestBinaryLogReader {
+    public:
+
+        AccTestBinaryLogReader(const char* data, std::size_t size)
+        : m_Data(data), m_Size(size) {
+            if (!IsValid() || size < AccTestBinaryLog::MagicSize + AccTestBinaryLog::TrailerSize)
+                return;
+            auto trailer = data + size - AccTestBinaryLog::TrailerSize;
+            if (std::string(trailer + 32, AccTestBinaryLog::MagicSize) != AccTestBinaryLog::GetIndexMagic())
+                return;
+            auto stringTableOffset = AccTestBinaryLog::ReadFixed(trailer);
+            auto numberOfStrings = AccTestBinaryLog::ReadFixed(trailer + 8);
+            auto scenarioTableOffset = AccTestBinaryLog::ReadFixed(trailer + 16);
+            auto numberOfScenarios = AccTestBinaryLog::ReadFixed(trailer + 24);
+            auto trailerOffset = static_cast<unsigned long long> (size - AccTestBinaryLog::TrailerSize);
+            if (stringTableOffset > scenarioTableOffset || numberOfStrings > (scenarioTableOffset - stringTableOffset) / 16 ||
+                    scenarioTableOffset > trailerOffset || numberOfScenarios > (trailerOffset - scenarioTableOffset) / 48)
+                return;
+            m_StringTable = data + stringTableOffset;
+            m_NumberOfStrings = static_cast<std::size_t> (numberOfStrings);
+            m_ScenarioTable = data + scenarioTableOffset;
+            m_NumberOfScenarios = static_cast<std::size_t> (numberOfScenarios);
+            m_EndOfRecords = static_cast<std::size_t> (stringTableOffset);
+        }
+
+        bool IsValid() const {
+            return m_Size >= AccTestBinaryLog::MagicSize && 
+                    std::string(m_Data, AccTestBinaryLog::MagicSize) == AccTestBinaryLog::GetMagic();
+        }
+
+        bool HasIndex() const {
+            return m_ScenarioTable != nullptr;
+        }
+
+        std::size_t GetNumberOfScenarios() const {
+            return m_NumberOfScenarios;
+        }
+
+        AccTestBinaryLog::ScenarioEntry GetScenario(std::size_t index) const {
+            auto fields = m_ScenarioTable + 48 * index;
+            AccTestBinaryLog::ScenarioEntry entry;
+            entry.Offset = AccTestBinaryLog::ReadFixed(fields);
+            entry.End = AccTestBinaryLog::ReadFixed(fields + 8);
+            entry.NameId = AccTestBinaryLog::ReadFixed(fields + 16);
+            entry.Status = AccTestBinaryLog::ReadFixed(fields + 24);
+            entry.StartTime = AccTestBinaryLog::ReadFixed(fields + 32);
+            entry.EndTime = AccTestBinaryLog::ReadFixed(fields + 40);
+            return entry;
+        }
+
+        std::string GetString(unsigned long long id) const {
+            if (id < m_NumberOfStrings) {
+                auto offset = AccTestBinaryLog::ReadFixed(m_StringTable + 16 * id);
+                auto length = AccTestBinaryLog::ReadFixed(m_StringTable + 16 * id + 8);
+                if (offset <= m_Size && length <= m_Size - offset)
+                    return std::string(m_Data + offset, static_cast<std::size_t> (length));
+            } else if (id < m_StringsRead.size())
+                return std::string(m_Data + m_StringsRead[id].first, m_StringsRead[id].second);
+            return std::string();
+        }
+
+        // Returns false once the records have run out or if the log is damaged.
+        bool ReplayScenario(std::size_t index, AccTestObserverIface& observer) {
+            auto entry = GetScenario(index);
+            auto position = static_cast<std::size_t> (entry.Offset);
+            AccTestEvent event(AccTestEventType::StartingTestSuite);
+            while (position < entry.End) {
+                if (!ReadEvent(position, event))
+                    return false;
+                AccTestEventRecorder::ReplayEvent(event, observer);
+            }
+            return true;
+        }
+
+        bool Replay(AccTestObserverIface& observer) {
+            std::size_t position = AccTestBinaryLog::MagicSize;
+            AccTestEvent event(AccTestEventType::StartingTestSuite);
+            while (position < m_EndOfRecords) {
+                if (!ReadEvent(position, event))
+                    return false;
+                AccTestEventRecorder::ReplayEvent(event, observer);
+            }
+            return true;
+        }
+
+        // Reads the event starting at position, skipping any string definitions in front of it. 
+        bool ReadEvent(std::size_t& position, AccTestEvent& event) {
+            typedef AccTestBinaryLog Log;
+            unsigned long long tag, value;
+            for (;;) {
+                if (position >= m_EndOfRecords || !Log::ReadVarint(m_Data, m_EndOfRecords, position, tag))
+                    return false;
+                if (tag != 0)
+                    break;
+                unsigned long long id, length;
+                if (!Log::ReadVarint(m_Data, m_EndOfRecords, position, id) || 
+                        !Log::ReadVarint(m_Data, m_EndOfRecords, position, length) || length > m_EndOfRecords - position)
+                    return false;
+                if (id == m_StringsRead.size())
+                    m_StringsRead.push_back(std::make_pair(position, static_cast<std::size_t> (length)));
+                position += static_cast<std::size_t> (length);
+            }
+            unsigned long long timeDelta, mask;
+            if (!Log::ReadVarint(m_Data, m_EndOfRecords, position, timeDelta) || 
+                    !Log::ReadVarint(m_Data, m_EndOfRecords, position, mask))
+                return false;
+            event = AccTestEvent(static_cast<AccTestEventType> (tag - 1));
+            if (mask & Log::HasName) {
+                if (!Log::ReadVarint(m_Data, m_EndOfRecords, position, value))
+                    return false;
+                event.Name = GetString(value);
+            }
+            if (mask & Log::HasDescription) {
+                if (!Log::ReadVarint(m_Data, m_EndOfRecords, position, value))
+                    return false;
+                event.Description = GetString(value);
+            }
+            if (mask & Log::HasCount) {
+                if (!Log::ReadVarint(m_Data, m_EndOfRecords, position, value))
+                    return false;
+                event.Count = static_cast<std::size_t> (value);
+            }
+            event.Flag = (mask & Log::HasFlag) != 0;
+            if (mask & Log::HasCheckOutputs) {
+                unsigned long long numberOfOutputs, checkIndex;
+                if (!Log::ReadVarint(m_Data, m_EndOfRecords, position, numberOfOutputs))
+                    return false;
+                for (unsigned long long output = 0; output < numberOfOutputs; ++output) {
+                    std::string text;
+                    if (!Log::ReadVarint(m_Data, m_EndOfRecords, position, checkIndex) || !ReadBytes(position, text))
+                        return false;
+                    event.CheckOutputs[static_cast<int> (checkIndex)] = text;
+                }
+            }
+            if (mask & Log::HasCheckRecords) {
+                unsigned long long numberOfRecords;
+                if (!Log::ReadVarint(m_Data, m_EndOfRecords, position, numberOfRecords))
+                    return false;
+                for (unsigned long long index = 0; index < numberOfRecords; ++index) {
+                    unsigned long long fields[5];
+                    for (auto& field : fields)
+                        if (!Log::ReadVarint(m_Data, m_EndOfRecords, position, field))
+                            return false;
+                    AccTestCheckRecord record;
+                    record.CheckIndex = static_cast<int> (fields[0]);
+                    record.Site.File = fields[1] ? AccTestCheckSite::Intern(GetString(fields[1] - 1)) : nullptr;
+                    record.Site.Line = static_cast<int> (fields[2]);
+                    record.Site.Expression = fields[3] ? AccTestCheckSite::Intern(GetString(fields[3] - 1)) : nullptr;
+                    record.OutputStart = static_cast<std::size_t> (fields[4]);
+                    event.CheckRecords.push_back(record);
+                }
+                if (!ReadBytes(position, event.CheckOutput))
+                    return false;
+            }
+            if (mask & Log::HasStepTiming) {
+                auto& timing = event.StepTiming;
+                AccTestClock::duration start;
+                if (!ReadDuration(position, start))
+                    return false;
+                timing.Start = AccTestClock::time_point(start);
+                for (auto phase : {&timing.Setup, &timing.Expect, &timing.Act, &timing.Verify, &timing.Teardown})
+                    if (!ReadDuration(position, *phase))
+                        return false;
+            }
+            if (mask & Log::HasScenarioTiming) {
+                auto& timing = event.ScenarioTiming;
+                AccTestClock::duration start;
+                if (!ReadDuration(position, start))
+                    return false;
+                timing.Start = AccTestClock::time_point(start);
+                for (auto phase : {&timing.Setup, &timing.Steps, &timing.Teardown})
+                    if (!ReadDuration(position, *phase))
+                        return false;
+            }
+            if (mask & Log::HasBenchmarkResult) {
+                auto& result = event.BenchmarkResult;
+                unsigned long long warmupIterations, iterations;
+                if (!Log::ReadVarint(m_Data, m_EndOfRecords, position, warmupIterations) || 
+                        !Log::ReadVarint(m_Data, m_EndOfRecords, position, iterations))
+                    return false;
+                result.WarmupIterations = static_cast<std::size_t> (warmupIterations);
+                result.Iterations = static_cast<std::size_t> (iterations);
+                for (auto statistic : {&result.Min, &result.Median, &result.Mean, &result.P90, &result.P99, &result.Max,
+                        &result.StdDev})
+                    if (!ReadDuration(position, *statistic))
+                        return false;
+            }
+            return true;
+        }
+
+    private:
+
+        bool ReadBytes(std::size_t& position, std::string& bytes) {
+            unsigned long long length;
+            if (!AccTestBinaryLog::ReadVarint(m_Data, m_EndOfRecords, position, length) || length > m_EndOfRecords - position)
+                return false;
+            bytes.assign(m_Data + position, static_cast<std::size_t> (length));
+            position += static_cast<std::size_t> (length);
+            return true;
+        }
+
+        bool ReadDuration(std::size_t& position, AccTestClock::duration& duration) {
+            long long nanoseconds;
+            if (!AccTestBinaryLog::ReadSigned(m_Data, m_EndOfRecords, position, nanoseconds))
+                return false;
+            duration = AccTestBinaryLog::FromNanoseconds(nanoseconds);
+            return true;
+        }
+
+        const char* m_Data;
+        std::size_t m_Size;
+        std::size_t m_EndOfRecords = m_Size;
+        const char* m_StringTable = nullptr;
+        std::size_t m_NumberOfStrings = 0;
+        const char* m_ScenarioTable = nullptr;
+        std::size_t m_NumberOfScenarios = 0;
+        std::vector<std::pair<std::size_t, std::size_t> > m_StringsRead;
+    };
+
+    // Writes the timeline of a suite run as a Chrome trace (the JSON trace event format) to be opened in the Perfetto UI or
+    // chrome://tracing. Each scenario is a slice holding the slices of its setup, its steps, and its tear-down, and each step
+    // holds the slices of its setup, expectations, act, verification, and tear-down. Slices are placed by the timings reported
+    // in StepTimed and ScenarioTimed rather than by when the events arrive, so the trace comes out the same whether the events
+    // are reported right away, replayed after a concurrent scenario finishes, or sent over from a worker process. Scenarios 
+    // running at the same time are laid out on separate tracks, each scenario on the first track free when it started; a run
+    // with N jobs therefore has at most N tracks, one for each worker that was busy. The trace is written when the suite 
+    // finishes. Scenarios whose worker process died have no timing of their own and are spanned by their steps, if any.
+
+    class AccTestTraceObserver : public AccTestEventRecorder {
+    public:
+
+        AccTestTraceObserver(std::ostream& outputStream)
+        : m_OutputStream(outputStream) {
+        }
+
+    protected:
+
+        void Record(const AccTestEvent& event) override {
+            switch (event.Type) {
+                case AccTestEventType::StartingScenario:
+                    m_Scenarios.push_back(Scenario());
+                    m_Scenarios.back().Name = event.Name;
+                    break;
+                case AccTestEventType::StartingScenarioStep:
+                    m_StepName = event.Name;
+                    break;
+                case AccTestEventType::StepTimed:
+                    if (!m_Scenarios.empty())
+                        m_Scenarios.back().Steps.push_back(std::make_pair(m_StepName, event.StepTiming));
+                    break;
+                case AccTestEventType::ScenarioTimed:
+                    if (!m_Scenarios.empty()) {
+                        m_Scenarios.back().Timing = event.ScenarioTiming;
+                        m_Scenarios.back().IsTimed = true;
+                    }
+                    break;
+                case AccTestEventType::FinishedTestSuite:
+                    WriteTrace();
+                    m_Scenarios.clear();
+                    break;
+                default:
+                    break;
+            }
+        }
+
+    private:
+
+        struct Scenario {
+            std::string Name;
+            AccTestScenarioTiming Timing;
+            bool IsTimed = false;
+            std::vector< std::pair<std::string, AccTestStepTiming> > Steps;
+        };
+
+        void WriteTrace() {
+            std::vector<std::size_t> order;
+            for (std::size_t index = 0; index < m_Scenarios.size(); ++index) {
+                auto& scenario = m_Scenarios[index];
+                if (!scenario.IsTimed && !scenario.Steps.empty()) {
+                    auto& lastStep = scenario.Steps.back().second;
+                    scenario.Timing.Start = scenario.Steps.front().second.Start;
+                    scenario.Timing.Steps = lastStep.Start + lastStep.GetTotal() - scenario.Timing.Start;
+                    scenario.IsTimed = true;
+                }
+                if (scenario.IsTimed)
+                    order.push_back(index);
+            }
+            std::sort(order.begin(), order.end(), [this](std::size_t left, std::size_t right) {
+                return m_Scenarios[left].Timing.Start < m_Scenarios[right].Timing.Start; });
+            m_Origin = order.empty() ? AccTestClock::time_point() : m_Scenarios[order.front()].Timing.Start;
+            std::ostringstream trace;
+            trace << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << '\n' <<
+                    "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"ProTest\"}}";
+            std::vector<AccTestClock::time_point> trackEnds;
+            for (auto index : order) {
+                const auto& scenario = m_Scenarios[index];
+                std::size_t track = 0;
+                while (track < trackEnds.size() && trackEnds[track] > scenario.Timing.Start)
+                    ++track;
+                if (track == trackEnds.size()) {
+                    trackEnds.push_back(AccTestClock::time_point());
+                    trace << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << track + 1 <<
+                            ",\"args\":{\"name\":\"Worker " << track + 1 << "\"}}";
+                }
+                trackEnds[track] = scenario.Timing.Start + scenario.Timing.GetTotal();
+                WriteScenario(trace, scenario, track + 1);
+            }
+            trace << '\n' << "]}" << '\n';
+            m_OutputStream << trace.str();
+            m_OutputStream.flush();
+        }
+
+        void WriteScenario(std::ostream& trace, const Scenario& scenario, std::size_t track) {
+            const auto& timing = scenario.Timing;
+            WriteSlice(trace, scenario.Name, "scenario", timing.Start, timing.GetTotal(), track);
+            WriteSlice(trace, "Setup", "scenario", timing.Start, timing.Setup, track);
+            for (const auto& step : scenario.Steps) {
+                const auto& stepTiming = step.second;
+                WriteSlice(trace, step.first, "step", stepTiming.Start, stepTiming.GetTotal(), track);
+                auto phaseStart = stepTiming.Start;
+                const AccTestClock::duration phases[] = {stepTiming.Setup, stepTiming.Expect, stepTiming.Act, stepTiming.Verify,
+                    stepTiming.Teardown};
+                const char* phaseNames[] = {"Setup", "Expect", "Act", "Verify", "Teardown"};
+                for (std::size_t phase = 0; phase < 5; ++phase) {
+                    if (phases[phase] > AccTestClock::duration::zero())
+                        WriteSlice(trace, phaseNames[phase], "phase", phaseStart, phases[phase], track);
+                    phaseStart += phases[phase];
+                }
+            }
+            WriteSlice(trace, "Teardown", "scenario", timing.Start + timing.Setup + timing.Steps, timing.Teardown, track);
+        }
+
+        void WriteSlice(std::ostream& trace, const std::string& name, const char* category, AccTestClock::time_point start,
+                AccTestClock::duration duration, std::size_t track) {
+            trace << ",\n{\"name\":";
+            WriteString(trace, name);
+            trace << ",\"cat\":\"" << category << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << track << ",\"ts\":" <<
+                    std::chrono::duration<double, std::micro>(start - m_Origin).count() << ",\"dur\":" <<
+                    std::chrono::duration<double, std::micro>(duration).count() << "}";
+        }
+
+        static void WriteString(std::ostream& trace, const std::string& text) {
+            trace << '"';
+            for (auto character : text) {
+                if (character == '"' || character == '\\')
+                    trace << '\\' << character;
+                else if (static_cast<unsigned char> (character) < 0x20) {
+                    const char* digits = "0123456789abcdef";
+                    trace << "\\u00" << digits[character >> 4] << digits[character & 0xf];
+                } else
+                    trace << character;
+            }
+            trace << '"';
+        }
+
+        std::ostream& m_OutputStream;
+        std::vector<Scenario> m_Scenarios;
+        std::string m_StepName;
+        AccTestClock::time_point m_Origin;
+    };
+
+#ifdef ACC_TEST_POSIX
+
+    // A pool of pre-forked worker processes executing a known number of tasks, each of which reports to an observer. The 
+    // workers are forked from the calling process once the tasks are ready to run, so they start with everything the parent 
+    // has already built and don't pay for starting the test program again. Each worker receives the index of its next task 
+    // over a pipe and streams the events of the task back over another pipe as they happen. The parent collects the events of
+    // a task and hands them to the observer in one piece once the task is done.
+    // If a worker dies in the middle of a task, e.g. because a step dereferenced a null pointer, whatever the task reported 
+    // up to that point is passed on followed by ScenarioCrashed and FinishedScenario, and a new worker is forked in its place.
+    // The same happens to a worker that is still busy with a task when the timeout set by SetTimeout runs out; it is killed.
+    // Tasks put in the same group with SetTaskGroups, e.g. scenarios using the same fixtures, which every worker process 
+    // builds for itself, are preferably given to the worker that ran the previous task of the group.
+    // The calling process must not be running other threads while the pool runs.
+
+    class AccTestProcessPool {
+    public:
+        typedef std::function<void(std::size_t task, AccTestObserverIface& observer)> TaskType;
+
+        AccTestProcessPool(std::size_t numberOfWorkers)
+        : m_NumberOfWorkers(std::max(numberOfWorkers, static_cast<std::size_t> (1))) {
+        }
+
+        // Zero, the default, lets tasks run for as long as they take.
+        void SetTimeout(AccTestClock::duration timeout) {
+            m_Timeout = timeout;
+        }
+
+        // The group number of every task, by task index; without them every task is a group of its own.
+        void SetTaskGroups(const std::vector<std::size_t>& taskGroups) {
+            m_TaskGroups = taskGroups;
+        }
+
+        // Returns the wall-clock time in seconds each task took, from handing it to a worker until its last event arrived.
+        std::vector<double> Run(std::size_t numberOfTasks, const TaskType& task, AccTestObserverIface& observer) {
+            std::vector<double> taskDurations(numberOfTasks);
+            auto previousSigPipeHandler = std::signal(SIGPIPE, SIG_IGN);
+            std::vector<Worker> workers(std::min(m_NumberOfWorkers, std::max(numberOfTasks, static_cast<std::size_t> (1))));
+            for (auto& worker : workers)
+                Spawn(worker, workers, task);
+            std::deque<std::size_t> pendingTasks;
+            for (std::size_t taskIndex = 0; taskIndex < numberOfTasks; ++taskIndex)
+                pendingTasks.push_back(taskIndex);
+            if (m_TaskGroups.size() != numberOfTasks)
+                m_TaskGroups = std::vector<std::size_t>(pendingTasks.begin(), pendingTasks.end());
+            std::size_t numberOfTasksFinished = 0;
+            while (numberOfTasksFinished < numberOfTasks) {
+                for (auto& worker : workers) {
+                    if (!worker.Busy && !pendingTasks.empty())
+                        Assign(worker, TakeTask(pendingTasks, worker, workers));
+                }
+                std::vector<pollfd> pollFds;
+                for (const auto& worker : workers) {
+                    pollfd pollFd = { worker.ResultFd, POLLIN, 0 };
+                    pollFds.push_back(pollFd);
+                }
+                if (poll(&pollFds[0], pollFds.size(), GetPollTimeout(workers)) < 0 && errno != EINTR)
+                    throw std::runtime_error(std::string("poll() failed: ") + std::strerror(errno));
+                for (std::size_t index = 0; index < workers.size(); ++index) {
+                    if (pollFds[index].revents == 0)
+                        continue;
+                    auto& worker = workers[index];
+                    auto taskOfWorker = worker.Task;
+                    auto taskStart = worker.TaskStart;
+                    auto wasBusy = worker.Busy;
+                    if (!Receive(worker, observer, numberOfTasksFinished)) {
+                        ReportCrash(worker, observer, numberOfTasksFinished);
+                        Spawn(worker, workers, task);
+                    }
+                    if (wasBusy && !worker.Busy) {
+                        taskDurations[taskOfWorker] =
+                                std::chrono::duration<double>(std::chrono::steady_clock::now() - taskStart).count();
+                    }
+                }
+                for (auto& worker : workers) {
+                    if (!worker.Busy || m_Timeout <= AccTestClock::duration::zero() ||
+                            AccTestClock::now() - worker.TaskStart < m_Timeout)
+                        continue;
+                    kill(worker.Pid, SIGKILL);
+                    taskDurations[worker.Task] = std::chrono::duration<double>(AccTestClock::now() - worker.TaskStart).count();
+                    std::ostringstream reason;
+                    reason << "exceeded the time limit of " << std::chrono::duration<double>(m_Timeout).count() << " s";
+                    ReportCrash(worker, observer, numberOfTasksFinished, reason.str());
+                    Spawn(worker, workers, task);
+                }
+            }
+            for (auto& worker : workers)
+                Stop(worker);
+            std::signal(SIGPIPE, previousSigPipeHandler);
+            return taskDurations;
+        }
+
+    private:
+
+        struct Worker {
+            pid_t Pid = -1;
+            int TaskFd = -1;
+            int ResultFd = -1;
+            bool Busy = false;
+            std::size_t Task = 0;
+            bool HasRunTask = false;
+            std::chrono::steady_clock::time_point TaskStart;
+            std::string Buffer;
+            std::size_t BufferPosition = 0;
+            AccTestEventRecorder Events;
+        };
+
+        static void Spawn(Worker& worker, std::vector<Worker>& workers, const TaskType& task) {
+            int taskPipe[2], resultPipe[2];
+            if (pipe(taskPipe) != 0 || pipe(resultPipe) != 0)
+                throw std::runtime_error(std::string("pipe() failed: ") + std::strerror(errno));
+            AccTestPipe::FlushStandardStreams();
+            auto pid = fork();
+            if (pid < 0)
+                throw std::runtime_error(std::string("fork() failed: ") + std::strerror(errno));
+            if (pid == 0) {
+                for (auto& other : workers) {
+                    if (other.TaskFd >= 0 && &other != &worker) {
+                        close(other.TaskFd);
+                        close(other.ResultFd);
+                    }
+                }
+                close(taskPipe[1]);
+                close(resultPipe[0]);
+                RunWorker(taskPipe[0], resultPipe[1], task);
+            }
+            close(taskPipe[0]);
+            close(resultPipe[1]);
+            worker = Worker();
+            worker.Pid = pid;
+            worker.TaskFd = taskPipe[1];
+            worker.ResultFd = resultPipe[0];
+        }
+
+        // Runs in the worker process: executes tasks until the parent closes the task pipe. The end of a task is signalled 
+        // with a FinishedTestSuite event, which a task never reports itself.
+        static void RunWorker(int taskFd, int resultFd, const TaskType& task) {
+            unsigned long long taskIndex;
+            AccTestEventPipeWriter eventWriter(resultFd);
+            while (AccTestPipe::ReadAll(taskFd, reinterpret_cast<char*> (&taskIndex), sizeof (taskIndex))) {
+                task(static_cast<std::size_t> (taskIndex), eventWriter);
+                eventWriter.FinishedTestSuite();
+                AccTestPipe::FlushStandardStreams();
+            }
+            _exit(0);
+        }
+
+        // Picks the next task for an idle worker: one of the group of the task it ran before, if any are left, then one of a 
+        // group no other worker has been on, then the first one left.
+        std::size_t TakeTask(std::deque<std::size_t>& pendingTasks, const Worker& worker, const std::vector<Worker>& workers) {
+            auto isGroupOf = [this](const Worker& someWorker, std::size_t task) {
+                return someWorker.HasRunTask && m_TaskGroups[someWorker.Task] == m_TaskGroups[task]; };
+            auto choice = std::find_if(pendingTasks.begin(), pendingTasks.end(), [&](std::size_t task) {
+                return isGroupOf(worker, task); });
+            if (choice == pendingTasks.end()) {
+                choice = std::find_if(pendingTasks.begin(), pendingTasks.end(), [&](std::size_t task) {
+                    return std::none_of(workers.begin(), workers.end(), [&](const Worker& other) {
+                        return isGroupOf(other, task); }); });
+            }
+            if (choice == pendingTasks.end())
+                choice = pendingTasks.begin();
+            auto task = *choice;
+            pendingTasks.erase(choice);
+            return task;
+        }
+
+        static void Assign(Worker& worker, std::size_t task) {
+            unsigned long long taskIndex = task;
+            worker.Busy = true;
+            worker.HasRunTask = true;
+            worker.Task = task;
+            worker.TaskStart = std::chrono::steady_clock::now();
+            AccTestPipe::WriteAll(worker.TaskFd, std::string(reinterpret_cast<const char*> (&taskIndex), sizeof (taskIndex)));
+        }
+
+        // Returns false when the worker has gone.
+        static bool Receive(Worker& worker, AccTestObserverIface& observer, std::size_t& numberOfTasksFinished) {
+            if (!AccTestPipe::ReadSome(worker.ResultFd, worker.Buffer))
+                return false;
+            AccTestEvent event;
+            while (AccTestEventCodec::Decode(worker.Buffer, worker.BufferPosition, event)) {
+                if (event.Type != AccTestEventType::FinishedTestSuite) {
+                    AccTestEventRecorder::ReplayEvent(event, worker.Events);
+                    continue;
+                }
+                worker.Events.Replay(observer);
+                worker.Events.Clear();
+                worker.Busy = false;
+                ++numberOfTasksFinished;
+            }
+            worker.Buffer.erase(0, worker.BufferPosition);
+            worker.BufferPosition = 0;
+            return true;
+        }
+
+        // Milliseconds until the first busy worker runs out of time, or -1 to wait indefinitely.
+        int GetPollTimeout(const std::vector<Worker>& workers) {
+            if (m_Timeout <= AccTestClock::duration::zero())
+                return -1;
+            auto timeout = -1;
+            for (const auto& worker : workers) {
+                if (!worker.Busy)
+                    continue;
+                auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(worker.TaskStart + m_Timeout - 
+                        AccTestClock::now()).count() + 1;
+                auto workerTimeout = static_cast<int> (std::max(remaining, static_cast<decltype(remaining)> (0)));
+                timeout = timeout < 0 ? workerTimeout : std::min(timeout, workerTimeout);
+            }
+            return timeout;
+        }
+
+        // The reason reported defaults to how the worker process ended.
+        static void ReportCrash(Worker& worker, AccTestObserverIface& observer, std::size_t& numberOfTasksFinished,
+                const std::string& reason = std::string()) {
+            close(worker.TaskFd);
+            close(worker.ResultFd);
+            auto status = AccTestPipe::WaitFor(worker.Pid);
+            if (!worker.Busy)
+                return;
+            bool scenarioStarted = false;
+            for (const auto& event : worker.Events.GetEvents()) {
+                if (event.Type == AccTestEventType::StartingScenario || event.Type == AccTestEventType::FinishedScenario)
+                    scenarioStarted = event.Type == AccTestEventType::StartingScenario;
+            }
+            worker.Events.Replay(observer);
+            if (!scenarioStarted) {
+                std::ostringstream name;
+                name << "Scenario #" << worker.Task + 1;
+                observer.StartingScenario(name.str(), "The process running the scenario died between scenario events.", 0);
+            }
+            observer.ScenarioCrashed(reason.empty() ? AccTestPipe::DescribeExitStatus(status) : reason);
+            observer.FinishedScenario();
+            ++numberOfTasksFinished;
+        }
+
+        static void Stop(Worker& worker) {
+            close(worker.TaskFd);
+            close(worker.ResultFd);
+            AccTestPipe::WaitFor(worker.Pid);
+        }
+
+        std::size_t m_NumberOfWorkers;
+        AccTestClock::duration m_Timeout = AccTestClock::duration::zero();
+        std::vector<std::size_t> m_TaskGroups;
+    };
+
+    // Runs sequences of tasks, each in a fresh process, starting from the state the calling process was in when the server was
+    // created. The constructor forks the server process, which forks a child for every sequence it is sent; the child runs 
+    // the sequence with its standard output and error discarded and exits with 0 if the last task passed and 1 if it failed. 
+    // A child that dies counts as failed. Create the server while the state is still clean, e.g. before any scenario runs, 
+    // and while the calling process isn't running other threads.
+
+    class AccTestForkServer {
+    public:
+        typedef std::function<bool(const std::vector<std::size_t>& sequence)> SequenceType;
+
+        AccTestForkServer(const SequenceType& runSequence) {
+            int requestPipe[2], resultPipe[2];
+            if (pipe(requestPipe) != 0 || pipe(resultPipe) != 0)
+                throw std::runtime_error(std::string("pipe() failed: ") + std::strerror(errno));
+            AccTestPipe::FlushStandardStreams();
+            m_Pid = fork();
+            if (m_Pid < 0)
+                throw std::runtime_error(std::string("fork() failed: ") + std::strerror(errno));
+            if (m_Pid == 0) {
+                close(requestPipe[1]);
+                close(resultPipe[0]);
+                Serve(requestPipe[0], resultPipe[1], runSequence);
+            }
+            close(requestPipe[0]);
+            close(resultPipe[1]);
+            m_RequestFd = requestPipe[1];
+            m_ResultFd = resultPipe[0];
+        }
+
+        ~AccTestForkServer() {
+            close(m_RequestFd);
+            close(m_ResultFd);
+            AccTestPipe::WaitFor(m_Pid);
+        }
+
+        // Runs up to numberOfJobs of the sequences at a time; returns whether the last task of each passed.
+        std::vector<bool> Run(const std::vector< std::vector<std::size_t> >& sequences, std::size_t numberOfJobs) {
+            std::vector<bool> passed(sequences.size());
+            std::size_t numberSent = 0, numberReceived = 0;
+            while (numberReceived < sequences.size()) {
+                while (numberSent < sequences.size() && numberSent - numberReceived < std::max(numberOfJobs, 
+                        static_cast<std::size_t> (1))) {
+                    std::vector<unsigned long long> request(1, numberSent);
+                    request.push_back(sequences[numberSent].size());
+                    request.insert(request.end(), sequences[numberSent].begin(), sequences[numberSent].end());
+                    if (!AccTestPipe::WriteAll(m_RequestFd, std::string(reinterpret_cast<const char*> (&request[0]), 
+                            request.size() * sizeof (request[0]))))
+                        throw std::runtime_error("The fork server has gone.");
+                    ++numberSent;
+                }
+                unsigned long long result[2];
+                if (!AccTestPipe::ReadAll(m_ResultFd, reinterpret_cast<char*> (result), sizeof (result)))
+                    throw std::runtime_error("The fork server has gone.");
+                passed[static_cast<std::size_t> (result[0])] = result[1] != 0;
+                ++numberReceived;
+            }
+            return passed;
+        }
+
+    private:
+
+        // Runs in the server process until the calling process closes the request pipe. Each request is the number of the 
+        // sequence, its length, and its tasks; each result the number of the sequence and whether it passed.
+        static void Serve(int requestFd, int resultFd, const SequenceType& runSequence) {
+            std::map<pid_t, unsigned long long> children;
+            auto requestsOpen = true;
+            while (requestsOpen || !children.empty()) {
+                int status;
+                pid_t pid;
+                while ((pid = waitpid(-1, &status, requestsOpen ? WNOHANG : 0)) > 0) {
+                    unsigned long long result[2] = {children[pid], WIFEXITED(status) && WEXITSTATUS(status) == 0};
+                    children.erase(pid);
+                    AccTestPipe::WriteAll(resultFd, std::string(reinterpret_cast<const char*> (result), sizeof (result)));
+                }
+                if (!requestsOpen)
+                    continue;
+                pollfd pollFd = { requestFd, POLLIN, 0 };
+                if (poll(&pollFd, 1, children.empty() ? -1 : 10) <= 0)
+                    continue;
+                unsigned long long header[2];
+                std::vector<unsigned long long> tasks;
+                requestsOpen = AccTestPipe::ReadAll(requestFd, reinterpret_cast<char*> (header), sizeof (header));
+                if (requestsOpen && header[1] > 0) {
+                    tasks.resize(static_cast<std::size_t> (header[1]));
+                    requestsOpen = AccTestPipe::ReadAll(requestFd, reinterpret_cast<char*> (&tasks[0]), 
+                            tasks.size() * sizeof (tasks[0]));
+                }
+                if (!requestsOpen)
+                    continue;
+                AccTestPipe::FlushStandardStreams();
+                pid = fork();
+                if (pid == 0) {
+                    close(requestFd);
+                    close(resultFd);
+                    auto nullFile = std::fopen("/dev/null", "w");
+                    if (nullFile) {
+                        dup2(fileno(nullFile), 1);
+                        dup2(fileno(nullFile), 2);
+                    }
+                    std::vector<std::size_t> sequence(tasks.begin(), tasks.end());
+                    auto sequencePassed = runSequence(sequence);
+                    AccTestPipe::FlushStandardStreams();
+                    _exit(sequencePassed ? 0 : 1);
+                }
+                if (pid > 0)
+                    children[pid] = header[0];
+                else {
+                    unsigned long long result[2] = {header[0], 0};
+                    AccTestPipe::WriteAll(resultFd, std::string(reinterpret_cast<const char*> (result), sizeof (result)));
+                }
+            }
+            _exit(0);
+        }
+
+        pid_t m_Pid;
+        int m_RequestFd;
+        int m_ResultFd;
+    };
+
+#endif // ACC_TEST_POSIX
+
+    // A fixed-size pool of worker threads executing a known number of independent tasks. The tasks are dealt out round-robin 
+    // to a deque per worker. Each worker takes tasks from the front of its own deque and, once that runs dry, steals from the 
+    // back of the other workers' deques, so a few long tasks landing on the same worker don't leave the others idle. No tasks 
+    // are added while the pool is running; a worker finding every deque empty is therefore done.
+    // Tasks can be put in groups with SetTaskGroups, e.g. scenarios using the same per-worker fixtures: a group is dealt to a 
+    // single deque, the one with the fewest tasks when the first task of the group comes up.
+
+    class AccTestWorkerPool {
+    public:
+
+        AccTestWorkerPool(std::size_t numberOfWorkers)
+        : m_NumberOfWorkers(std::max(numberOfWorkers, static_cast<std::size_t> (1))) {
+        }
+
+        std::size_t GetNumberOfWorkers() {
+            return m_NumberOfWorkers;
+        }
+
+        // The group number of every task, by task index; without them every task is a group of its own.
+        void SetTaskGroups(const std::vector<std::size_t>& taskGroups) {
+            m_TaskGroups = taskGroups;
+        }
+
+        void Run(std::size_t numberOfTasks, const std::function<void(std::size_t task, std::size_t worker)>& task) {
+            std::vector<TaskQueue> queues(m_NumberOfWorkers);
+            std::map<std::size_t, std::size_t> queueOfGroup;
+            auto grouped = m_TaskGroups.size() == numberOfTasks;
+            for (std::size_t taskIndex = 0; taskIndex < numberOfTasks; ++taskIndex) {
+                auto group = grouped ? queueOfGroup.find(m_TaskGroups[taskIndex]) : queueOfGroup.end();
+                if (group == queueOfGroup.end()) {
+                    auto queue = static_cast<std::size_t> (std::min_element(queues.begin(), queues.end(), 
+                            [](const TaskQueue& left, const TaskQueue& right) {
+                                return left.Tasks.size() < right.Tasks.size(); }) - queues.begin());
+                    group = queueOfGroup.insert(std::make_pair(grouped ? m_TaskGroups[taskIndex] : taskIndex, queue)).first;
+                }
+                queues[group->second].Tasks.push_back(taskIndex);
+            }
+            std::vector<std::thread> workers;
+            for (std::size_t worker = 1; worker < m_NumberOfWorkers; ++worker)
+                workers.push_back(std::thread([&queues, &task, worker]() {
+                    RunWorker(queues, task, worker); }));
+            RunWorker(queues, task, 0);
+            for (auto& worker : workers)
+                worker.join();
+        }
+
+    private:
+
+        struct TaskQueue {
+            std::mutex Mutex;
+            std::deque<std::size_t> Tasks;
+        };
+
+        static void RunWorker(std::vector<TaskQueue>& queues,
+                const std::function<void(std::size_t task, std::size_t worker)>& task, std::size_t worker) {
+            std::size_t taskIndex;
+            while (PopOwn(queues[worker], taskIndex) || Steal(queues, worker, taskIndex))
+                task(taskIndex, worker);
+        }
+
+        static bool PopOwn(TaskQueue& queue, std::size_t& taskIndex) {
+            std::lock_guard<std::mutex> lock(queue.Mutex);
+            if (queue.Tasks.empty())
+                return false;
+            taskIndex = queue.Tasks.front();
+            queue.Tasks.pop_front();
+            return true;
+        }
+
+        static bool Steal(std::vector<TaskQueue>& queues, std::size_t thief, std::size_t& taskIndex) {
+            for (std::size_t offset = 1; offset < queues.size(); ++offset) {
+                auto& victim = queues[(thief + offset) % queues.size()];
+                std::lock_guard<std::mutex> lock(victim.Mutex);
+                if (!victim.Tasks.empty()) {
+                    taskIndex = victim.Tasks.back();
+                    victim.Tasks.pop_back();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        std::size_t m_NumberOfWorkers;
+        std::vector<std::size_t> m_TaskGroups;
+    };
+
+    // Remembers how long each scenario took in earlier runs, keyed by the scenario name, in a small text file with one line 
+    // per scenario: the duration in seconds followed by the name. A new measurement is averaged with the remembered one so a 
+    // single unusually slow or fast run doesn't turn the schedule upside down.
+    // GetLongestFirstOrder puts the scenarios in order of decreasing remembered duration, which is the order that keeps a 
+    // parallel run from ending with one long scenario started last. Scenarios without a remembered duration go first, in the 
+    // order given, since nothing suggests they are short; without any history at all the given order is kept as it is.
+
+    class AccTestDurationHistory {
+    public:
+
+        bool Load(const std::string& path) {
+            std::ifstream input(path.c_str());
+            if (!input)
+                return false;
+            double seconds;
+            std::string name;
+            while (input >> seconds && std::getline(input >> std::ws, name))
+                m_Durations[name] = seconds;
+            return true;
+        }
+
+        bool Save(const std::string& path) const {
+            std::ofstream output(path.c_str());
+            for (const auto& duration : m_Durations)
+                output << duration.second << " " << duration.first << "\n";
+            return static_cast<bool> (output);
+        }
+
+        bool GetDuration(const std::string& name, double& seconds) const {
+            auto duration = m_Durations.find(name);
+            if (duration == m_Durations.end())
+                return false;
+            seconds = duration->second;
+            return true;
+        }
+
+        void AddMeasurement(const std::string& name, double seconds) {
+            auto duration = m_Durations.find(name);
+            if (duration == m_Durations.end())
+                m_Durations[name] = seconds;
+            else
+                duration->second = (duration->second + seconds) / 2;
+        }
+
+        std::vector<std::size_t> GetLongestFirstOrder(const std::vector<std::string>& names) const {
+            std::vector<double> durations(names.size(), -1);
+            for (std::size_t index = 0; index < names.size(); ++index) {
+                if (!GetDuration(names[index], durations[index]))
+                    durations[index] = std::numeric_limits<double>::infinity();
+            }
+            std::vector<std::size_t> order(names.size());
+            for (std::size_t index = 0; index < order.size(); ++index)
+                order[index] = index;
+            std::stable_sort(order.begin(), order.end(), [&durations](std::size_t left, std::size_t right) {
+                return durations[left] > durations[right];
+            });
+            return order;
+        }
+
+    private:
+        std::map<std::string, double> m_Durations;
+    };
+
+    // Remembers which scenarios passed, in a small text file: a first line with the fingerprint of the test program, e.g. the
+    // hash of its executable, followed by a line per scenario that passed with its key (see GetKey) and name. The entries of 
+    // a file written with another fingerprint are ignored, so a new build starts from an empty cache, and only the scenarios 
+    // that passed again are kept. Scenarios are told apart by name, so scenarios sharing a name can't be cached.
+
+    class AccTestResultCache {
+    public:
+
+        AccTestResultCache(const std::string& fingerprint)
+        : m_Fingerprint(fingerprint) {
+        }
+
+        bool Load(const std::string& path) {
+            std::ifstream input(path.c_str());
+            std::string line;
+            if (!std::getline(input, line) || line != "fingerprint " + m_Fingerprint)
+                return false;
+            std::string key, name;
+            while (input >> key && std::getline(input >> std::ws, name))
+                m_Passed[name] = key;
+            return true;
+        }
+
+        bool Save(const std::string& path) const {
+            std::ofstream output(path.c_str());
+            output << "fingerprint " << m_Fingerprint << "\n";
+            for (const auto& passed : m_Passed)
+                output << passed.second << " " << passed.first << "\n";
+            return static_cast<bool> (output);
+        }
+
+        // The key changes whenever the name or description of the scenario or the names or descriptions of its steps change 
+        // (see AccTestScenarioBase::GetStepListHash), the same inputs that invalidate its checkpoints. Scenarios built from 
+        // different data must say so in one of them to be cached apart.
+        static std::string GetKey(const std::string& scenarioName, const std::string& scenarioDescription, 
+                const std::string& stepListHash) {
+            return AccTestFingerprint::ToHex(AccTestFingerprint::Hash(scenarioName + "\n" + scenarioDescription + "\n" + 
+                    stepListHash));
+        }
+
+        bool HasEntry(const std::string& scenarioName) const {
+            return m_Passed.count(scenarioName) > 0;
+        }
+
+        bool HasPassed(const std::string& scenarioName, const std::string& key) const {
+            auto passed = m_Passed.find(scenarioName);
+            return passed != m_Passed.end() && passed->second == key;
+        }
+
+        void SetResult(const std::string& scenarioName, const std::string& key, bool passed) {
+            if (passed)
+                m_Passed[scenarioName] = key;
+            else
+                m_Passed.erase(scenarioName);
+        }
+
+    private:
+        std::string m_Fingerprint;
+        std::map<std::string, std::string> m_Passed;
+    };
+
+    // What the suite knows about a scenario without constructing it. Declaring the name of a scenario when it is created (see 
+    // AccTestSuite::CreateScenario) lets the suite schedule, select, and report it before it is built; the tags are free-form
+    // labels for grouping scenarios. Fixtures names the shared fixtures of the suite the scenario uses (see 
+    // AccTestSuite::CreateFixture).
+
+    struct AccTestScenarioInfo {
+        std::string Name;
+        std::vector<std::string> Tags;
+        std::vector<std::string> Fixtures;
+    };
+
+    // Matches names against a filter of the form POSITIVE[:POSITIVE...][-NEGATIVE[:NEGATIVE...]]. A name passes the filter if 
+    // it matches at least one of the positive patterns, or there are none, and none of the negative ones. A pattern is a glob 
+    // where * stands for any sequence of characters and ? for any single character, unless it is enclosed in slashes, as in 
+    // /Input[0-9]+/, which makes it an ECMAScript regular expression that may match any part of the name. Colons and dashes 
+    // inside slashes belong to the regular expression. An empty filter lets everything pass.
+
+    class AccTestNameFilter {
+    public:
+
+        AccTestNameFilter(const std::string& filter = "") {
+            bool negative = false, inRegex = false;
+            std::string pattern;
+            for (auto character : filter) {
+                if (character == '/' && (inRegex || pattern.empty()))
+                    inRegex = !inRegex;
+                else if (!inRegex && (character == ':' || (character == '-' && !negative))) {
+                    AddPattern(pattern, negative);
+                    negative = negative || character == '-';
+                    pattern.clear();
+                    continue;
+                }
+                pattern.push_back(character);
+            }
+            if (inRegex)
+                throw std::invalid_argument("Unterminated regular expression in filter: " + filter);
+            AddPattern(pattern, negative);
+        }
+
+        bool IsEmpty() const {
+            return m_Positive.empty() && m_Negative.empty();
+        }
+
+        bool Matches(const std::string& name) const {
+            return (m_Positive.empty() || MatchesAnyPattern(m_Positive, name)) && !MatchesAnyPattern(m_Negative, name);
+        }
+
+        // For sets of names such as the tags of a scenario: at least one name must match a positive pattern and none may 
+        // match a negative one.
+        bool MatchesAny(const std::vector<std::string>& names) const {
+            bool positiveMatch = m_Positive.empty();
+            for (const auto& name : names) {
+                if (MatchesAnyPattern(m_Negative, name))
+                    return false;
+                positiveMatch = positiveMatch || MatchesAnyPattern(m_Positive, name);
+            }
+            return positiveMatch;
+        }
+
+        static bool MatchesGlob(const std::string& glob, const std::string& name) {
+            std::size_t globIndex = 0, nameIndex = 0, starIndex = std::string::npos, starNameIndex = 0;
+            while (nameIndex < name.size()) {
+                if (globIndex < glob.size() && (glob[globIndex] == '?' || glob[globIndex] == name[nameIndex])) {
+                    ++globIndex;
+                    ++nameIndex;
+                } else if (globIndex < glob.size() && glob[globIndex] == '*') {
+                    starIndex = globIndex++;
+                    starNameIndex = nameIndex;
+                } else if (starIndex != std::string::npos) {
+                    globIndex = starIndex + 1;
+                    nameIndex = ++starNameIndex;
+                } else
+                    return false;
+            }
+            while (globIndex < glob.size() && glob[globIndex] == '*')
+                ++globIndex;
+            return globIndex == glob.size();
+        }
+
+    private:
+
+        struct Pattern {
+            std::string Glob;
+            bool IsRegex = false;
+            std::regex Regex;
+        };
+
+        void AddPattern(const std::string& text, bool negative) {
+            if (text.empty())
+                return;
+            Pattern pattern;
+            if (text.size() > 1 && text.front() == '/' && text.back() == '/') {
+                pattern.IsRegex = true;
+                try {
+                    pattern.Regex = std::regex(text.substr(1, text.size() - 2));
+                } catch (const std::regex_error& error) {
+                    throw std::invalid_argument("Invalid regular expression in filter: " + text + " (" + error.what() + ")");
+                }
+            } else
+                pattern.Glob = text;
+            (negative ? m_Negative : m_Positive).push_back(pattern);
+        }
+
+        static bool MatchesAnyPattern(const std::vector<Pattern>& patterns, const std::string& name) {
+            for (const auto& pattern : patterns) {
+                if (pattern.IsRegex ? std::regex_search(name, pattern.Regex) : MatchesGlob(pattern.Glob, name))
+                    return true;
+            }
+            return false;
+        }
+
+        std::vector<Pattern> m_Positive;
+        std::vector<Pattern> m_Negative;
+    };
+
+    // Options controlling how a test suite executes its scenarios. NumberOfJobs is the number of scenarios run concurrently; 
+    // 1 (the default) runs them one after the other on the calling thread and 0 uses one job per hardware thread.
+    // ScenarioFilter, TagFilter, and StepFilter select the scenarios to run (see AccTestNameFilter for the syntax): only the
+    // scenarios whose name passes ScenarioFilter, at least one of whose tags passes TagFilter, and at least one of whose steps
+    // has a name passing StepFilter are run. The first two only look at the AccTestScenarioInfo of the scenario, so filtered 
+    // out scenarios are never constructed as long as their names are declared. Step names are only known once the scenario is
+    // built, so StepFilter constructs the scenarios that passed the other filters (and belong to the shard) to look at them.
+    // ShardCount and ShardIndex split the suite into ShardCount disjoint parts of which only part number ShardIndex (counting
+    // from zero) is run. A scenario belongs to the shard given by its position among the scenarios passing ScenarioFilter and 
+    // TagFilter, in the order of creation, modulo ShardCount, so every process running the same suite binary with the same 
+    // filters agrees on the split. Scenarios of other shards are never constructed.
+    // With IsolateScenarios turned on, the scenarios are run in NumberOfJobs pre-forked worker processes (see 
+    // AccTestProcessPool) instead of threads, so a scenario crashing its process is reported as terminated and doesn't take 
+    // the rest of the suite down with it. It is only available where ACC_TEST_POSIX is defined.
+    // If DurationHistoryFile is set, the duration of every scenario is stored in that file (see AccTestDurationHistory) and 
+    // scenarios running in parallel are started longest first according to the durations of the earlier runs.
+    // If ResultCacheFile is set, the scenarios that pass are remembered in that file (see AccTestResultCache), and those that
+    // passed in an earlier run of the same test program with the same steps are reported as cached rather than run again, 
+    // unless ForceRun is set. The test program is told apart by the hash of its executable, or by ResultCacheFingerprint if 
+    // that is set, e.g. to a hash of the code under test and the data the scenarios read; without either nothing is cached.
+    // Scenarios with order dependencies, or depending on anything else outside the test program, shouldn't be cached; 
+    // scenarios sharing a name never are.
+    // Checkpoints and Baselines are handed to every scenario before it runs.
+
+    struct AccTestSuiteOptions {
+        std::size_t NumberOfJobs = 1;
+        std::size_t ShardIndex = 0;
+        std::size_t ShardCount = 1;
+        std::string ScenarioFilter;
+        std::string TagFilter;
+        std::string StepFilter;
+        bool IsolateScenarios = false;
+        std::size_t RepeatCount = 1;
+        bool ShuffleScenarios = false;
+        unsigned long ShuffleSeed = 0;
+        // A scenario still running after this long is killed along with the worker process running it; any timeout makes 
+        // the scenarios run in worker processes. Zero for no limit.
+        AccTestClock::duration ScenarioTimeout = AccTestClock::duration::zero();
+        // Runs the scenarios one after the other in this process and, for every scenario that fails there but passes on its
+        // own, looks for a minimal set of the scenarios before it that still makes it fail (see 
+        // AccTestSuite::GetOrderDependencies). NumberOfJobs then sets how many candidate sets are tried at once; isolation
+        // and timeouts don't apply. POSIX platforms only.
+        bool BisectOrderDependencies = false;
+        std::string DurationHistoryFile;
+        std::string ResultCacheFile;
+        std::string ResultCacheFingerprint;
+        bool ForceRun = false;
+        AccTestCheckpointOptions Checkpoints;
+        AccTestBaselineOptions Baselines;
+    };
+
+    // A scenario that failed in a run of the suite but passes on its own, with a minimal set of the scenarios that ran before 
+    // it, in their order in the run, that make it fail again when run before it in a fresh process.
+
+    struct AccTestOrderDependency {
+        std::string Scenario;
+        std::vector<std::string> PrecedingScenarios;
+    };
+
+    // How many instances of a shared fixture a suite builds: one for the whole suite, which the scenarios running on different
+    // threads use at the same time, or one per worker thread, for fixtures that can't be used by two scenarios at once.
+
+    enum class AccTestFixtureScope {
+        Suite,
+        Worker
+    };
+
+    // In most cases you have more than one test scenario with sequential steps that has its own starting point, steps, and cleanup.
+    // To accommodate these situations you can use a test suite which is basically a collection of unrelated test scenarios. Simply
+    // inherit AccTestSuite and, within your constructor, create and add your test scenarios using calls to AddScenario. Afterwards,
+    // you can run all the scenarios in the test suite by a call to the Run method. This executes all the scenarios in the same 
+    // order as they were added. The order shouldn't matter as the test scenarios are supposed to be unrelated, i.e., each scenario
+    // has its own Setup which is supposed to set the preconditions regardless of anything else that might have happened before.
+    // The Run method returns the complete report for all the test scenarios within the suite.
+    // CreateScenario doesn't build the scenario but stores what is needed to build it. Each scenario is constructed right before
+    // it runs and destroyed as soon as it has finished, so only the scenarios actually running occupy memory at any time. Give
+    // CreateScenario an AccTestScenarioInfo before the construction arguments to declare the name and tags of the scenario 
+    // up front; otherwise the suite has to construct a scenario whenever it needs its name before running it.
+    // Because the scenarios are independent, they may also be run concurrently by setting NumberOfJobs in the suite options. 
+    // Each concurrently running scenario reports to its own AccTestEventRecorder and its events are handed to the test observer 
+    // as a whole once the scenario has finished, so the observer never sees the events of two scenarios interleaved. The 
+    // scenarios are then reported in the order they finish rather than the order they were added.
+    // Expensive resources that many scenarios need, e.g. a reference database they only read, can be built once as shared 
+    // fixtures instead of in the Setup of every scenario. Create them with CreateFixture, which again stores only what is 
+    // needed to build them, list them in the AccTestScenarioInfo of the scenarios using them, and get them in the scenario with
+    // GetFixture. A fixture is built when the first of its scenarios asks for it and destroyed as soon as the last of its 
+    // scenarios in the run has finished. In parallel runs, scenarios using the same fixtures are handed to the same worker 
+    // where possible, which matters for per-worker fixtures and for worker processes: every worker process builds its own 
+    // instances, which last as long as the process.
+    // With a ResultCacheFile in the options, the suite skips the scenarios that passed in an earlier run of the same build and
+    // reports them as cached; they are constructed once, but not run, to check that their steps are still the same.
+
+    class AccTestSuite {
+    public:
+
+        AccTestSuite()
+        : m_TestObs(std::make_shared<AccTestObserver>(std::cout)) {
+        }
+
+        void SetTestObserver(std::shared_ptr<AccTestObserverIface> testObs) {
+            m_TestObs = testObs;
+        }
+
+        void SetOptions(const AccTestSuiteOptions& options) {
+            m_Options = options;
+        }
+
+        const AccTestSuiteOptions& GetOptions() {
+            return m_Options;
+        }
+
+        // The order dependencies found by the last run with BisectOrderDependencies set.
+        const std::vector<AccTestOrderDependency>& GetOrderDependencies() {
+            return m_OrderDependencies;
+        }
+
+        void Run() {
+            auto selected = SelectScenarios();
+            auto numberOfJobs = m_Options.NumberOfJobs != 0 ? m_Options.NumberOfJobs :
+                    std::max(std::thread::hardware_concurrency(), 1u);
+            auto bisects = m_Options.BisectOrderDependencies;
+            auto runsInWorkerProcesses = !bisects &&
+                    (m_Options.IsolateScenarios || m_Options.ScenarioTimeout > AccTestClock::duration::zero());
+            auto runsInParallel = !bisects && (runsInWorkerProcesses || (numberOfJobs > 1 && selected.size() > 1));
+            AccTestDurationHistory history;
+            std::vector<std::string> names(selected.size());
+            if (!m_Options.DurationHistoryFile.empty() && runsInParallel) {
+                history.Load(m_Options.DurationHistoryFile);
+                for (std::size_t index = 0; index < selected.size(); ++index)
+                    names[index] = GetScenarioName(selected[index]);
+            }
+            auto order = history.GetLongestFirstOrder(names);
+            std::vector<std::size_t> orderedScenarios;
+            for (std::size_t repetition = 0; repetition < m_Options.RepeatCount; ++repetition) {
+                for (auto index : order)
+                    orderedScenarios.push_back(selected[index]);
+            }
+            if (m_Options.ShuffleScenarios)
+                Shuffle(orderedScenarios, m_Options.ShuffleSeed);
+            auto fingerprint = m_Options.ResultCacheFingerprint;
+            if (fingerprint.empty() && AccTestFingerprint::GetExecutableHash() != 0)
+                fingerprint = AccTestFingerprint::ToHex(AccTestFingerprint::GetExecutableHash());
+            auto cachesResults = !bisects && !m_Options.ResultCacheFile.empty() && !fingerprint.empty();
+            AccTestResultCache cache(fingerprint);
+            std::set<std::string> sharedNames;
+            std::vector<std::size_t> cached;
+            if (cachesResults) {
+                cache.Load(m_Options.ResultCacheFile);
+                sharedNames = GetSharedNames(orderedScenarios);
+                cached = TakeCachedScenarios(orderedScenarios, cache, sharedNames);
+            }
+            PrepareFixtures(orderedScenarios);
+            std::vector<double> durations(orderedScenarios.size());
+            m_OrderDependencies.clear();
+            auto testObs = m_TestObs;
+            auto verdicts = std::make_shared<AccTestVerdictObserver>();
+            if (cachesResults) {
+                auto group = std::make_shared<AccTestObserverGroup>();
+                group->Add(testObs);
+                group->Add(verdicts);
+                m_TestObs = group;
+            }
+            m_TestObs->StartingTestSuite(cached.size() + orderedScenarios.size());
+            try {
+                for (auto index : cached) {
+                    const auto& scenario = m_Scenarios[index];
+                    testObs->StartingScenario(scenario.Info.Name, scenario.Description, scenario.NumberOfSteps);
+                    testObs->ScenarioCached();
+                    testObs->FinishedScenario();
+                }
+                if (bisects)
+                    RunAndBisect(orderedScenarios, numberOfJobs, durations);
+                else if (runsInWorkerProcesses)
+                    durations = RunInWorkerProcesses(orderedScenarios, numberOfJobs);
+                else if (runsInParallel)
+                    RunConcurrently(orderedScenarios, numberOfJobs, durations);
+                else {
+                    for (std::size_t index = 0; index < orderedScenarios.size(); ++index)
+                        durations[index] = RunScenario(orderedScenarios[index], m_TestObs);
+                }
+                ReleaseFixtures();
+                m_TestObs->FinishedTestSuite();
+            } catch (...) {
+                m_TestObs = testObs;
+                throw;
+            }
+            m_TestObs = testObs;
+            if (cachesResults) {
+                for (auto index : orderedScenarios) {
+                    const auto& name = GetScenarioName(index);
+                    const auto& key = GetCacheKey(index);
+                    cache.SetResult(name, key, !key.empty() && !sharedNames.count(name) && 
+                            HasPassed(name, verdicts->GetScenarioVerdicts()));
+                }
+                cache.Save(m_Options.ResultCacheFile);
+            }
+            if (!m_Options.DurationHistoryFile.empty()) {
+                if (!runsInParallel)
+                    history.Load(m_Options.DurationHistoryFile);
+                for (std::size_t index = 0; index < orderedScenarios.size(); ++index)
+                    history.AddMeasurement(GetScenarioName(orderedScenarios[index]), durations[index]);
+                history.Save(m_Options.DurationHistoryFile);
+            }
+        }
+
+    protected:
+
+        template <class ScenType, class... Args>
+        void CreateScenario(Args... constructionArgs) {
+            CreateScenario<ScenType>(AccTestScenarioInfo(), constructionArgs...);
+        }
+
+        template <class ScenType, class... Args>
+        void CreateScenario(const AccTestScenarioInfo& info, Args... constructionArgs) {
+            ScenarioEntry entry;
+            entry.Info = info;
+            entry.Create = [constructionArgs...]() -> std::shared_ptr<AccTestScenarioBase> {
+                return std::make_shared<ScenType>(constructionArgs...);
+            };
+            m_Scenarios.push_back(entry);
         }
 
-        void FinishedScenario() override {
-            m_OutputStream << "  Finished execution of test scenario." << std::endl;
-            if (m_NumberOfStepsPassed == m_NumberOfStepsInScenario)
-                m_OutputStream << "    All steps passed successfully. Total: " << m_NumberOfStepsInScenario << std::endl;
-            else {
-                m_OutputStream << "    Number of failed steps: " << m_NumberOfStepsFailed <<
-                        " out of " << m_NumberOfStepsInScenario << std::endl;
-                auto omittedSteps = m_NumberOfStepsInScenario - m_NumberOfStepsPassed - m_NumberOfStepsFailed;
-                if (omittedSteps > 0) {
-                    m_OutputStream << "    Number of omitted steps: " << omittedSteps <<
-                            " out of " << m_NumberOfStepsInScenario << std::endl;
-                } else
-                    ++m_NumberOfScenariosFailed;
+        template <class FixtureType, class... Args>
+        void CreateFixture(const std::string& name, AccTestFixtureScope scope, Args... constructionArgs) {
+            auto& fixture = m_Fixtures[name];
+            fixture.Scope = scope;
+            fixture.Type = &typeid(FixtureType);
+            fixture.Create = [constructionArgs...]() -> std::shared_ptr<void> {
+                return std::make_shared<FixtureType>(constructionArgs...);
+            };
+        }
+
+    private:
+
+        // Description, NumberOfSteps, and CacheKey are filled in by Describe when the scenario is first constructed, so that
+        // the result cache and the report of a cached scenario don't need to construct it again.
+        struct ScenarioEntry {
+            AccTestScenarioInfo Info;
+            std::function<std::shared_ptr<AccTestScenarioBase>()> Create;
+            bool IsDescribed = false;
+            std::string Description;
+            std::size_t NumberOfSteps = 0;
+            std::string CacheKey;
+        };
+
+        void Describe(std::size_t scenarioIndex, AccTestScenarioBase& scenario) {
+            std::lock_guard<std::mutex> lock(m_DescriptionMutex);
+            auto& entry = m_Scenarios[scenarioIndex];
+            if (entry.Info.Name.empty())
+                entry.Info.Name = scenario.GetName();
+            if (entry.IsDescribed)
+                return;
+            entry.Description = scenario.GetDescription();
+            entry.NumberOfSteps = scenario.GetStepNames().size();
+            entry.CacheKey = AccTestResultCache::GetKey(entry.Info.Name, entry.Description, scenario.GetStepListHash());
+            entry.IsDescribed = true;
+        }
+
+        // Empty for a scenario that can't be constructed. Scenarios that ran in worker processes are constructed once more 
+        // here, as they were described in the workers only.
+        const std::string& GetCacheKey(std::size_t scenarioIndex) {
+            std::string error;
+            if (!m_Scenarios[scenarioIndex].IsDescribed)
+                ConstructScenario(scenarioIndex, error);
+            return m_Scenarios[scenarioIndex].CacheKey;
+        }
+
+        // The names more than one scenario of the run goes by; the result cache can't tell their results apart.
+        std::set<std::string> GetSharedNames(const std::vector<std::size_t>& scenarios) {
+            std::map<std::string, std::size_t> scenarioOfName;
+            std::set<std::string> sharedNames;
+            for (auto index : scenarios) {
+                auto scenario = scenarioOfName.insert(std::make_pair(GetScenarioName(index), index));
+                if (scenario.first->second != index)
+                    sharedNames.insert(scenario.first->first);
             }
-            m_OutputStream << std::endl;
-            m_CurrentStepIndex = m_NumberOfStepsInScenario = m_NumberOfStepsPassed = m_NumberOfStepsFailed = 0;
+            return sharedNames;
         }
 
-        void FinishedTestSuite() override {
-            m_OutputStream << "Finished execution of test suite." << std::endl;
-            if (m_NumberOfScenariosFailed == 0 && m_NumberOfScenariosTerminated == 0)
-                m_OutputStream << "  All scenarios completed successfully." << std::endl;
-            else {
-                if (m_NumberOfScenariosFailed > 0)
-                    m_OutputStream << "  Number of failed scenarios: " << m_NumberOfScenariosFailed <<
-                        " out of " << m_NumberOfScenarios << std::endl;
-                if (m_NumberOfScenariosTerminated > 0)
-                    m_OutputStream << "  Number of terminated scenarios: " << m_NumberOfScenariosTerminated <<
-                        " out of " << m_NumberOfScenarios << std::endl;
+        // Moves the scenarios that passed in an earlier run from scenarios to the list returned, keeping the order of both. 
+        // Only the scenarios with an entry in the cache need to be constructed, if they haven't been yet, to check their key.
+        std::vector<std::size_t> TakeCachedScenarios(std::vector<std::size_t>& scenarios, const AccTestResultCache& cache,
+                const std::set<std::string>& sharedNames) {
+            std::vector<std::size_t> running, cached;
+            for (auto index : scenarios) {
+                const auto& name = GetScenarioName(index);
+                auto isCached = !m_Options.ForceRun && !sharedNames.count(name) && cache.HasEntry(name) && 
+                        cache.HasPassed(name, GetCacheKey(index));
+                (isCached ? cached : running).push_back(index);
             }
-            m_CurrentScenarioIndex = m_NumberOfScenarios = m_NumberOfScenariosFailed = m_NumberOfScenariosTerminated = 0;
+            scenarios.swap(running);
+            return cached;
         }
 
-        std::size_t GetNumberOfScenariosPassed() {
-            return m_NumberOfScenarios - m_NumberOfScenariosFailed - m_NumberOfScenariosTerminated;
+        // Branching scenarios report a scenario per branch, named after the scenario followed by a slash and the branch.
+        static bool HasPassed(const std::string& scenarioName, const std::map<std::string, bool>& verdicts) {
+            auto passed = false;
+            for (auto verdict = verdicts.lower_bound(scenarioName); verdict != verdicts.end() && 
+                    verdict->first.compare(0, scenarioName.size(), scenarioName) == 0; ++verdict) {
+                if (verdict->first.size() != scenarioName.size() && verdict->first[scenarioName.size()] != '/')
+                    continue;
+                if (!verdict->second)
+                    return false;
+                passed = true;
+            }
+            return passed;
         }
 
-        std::size_t GetNumberOfScenarios() {
-            return m_NumberOfScenarios;
+        // Instances holds the instance of the whole suite under worker 0. Mutex guards Remaining and Instances, and is held
+        // while an instance is built so that scenarios asking for it at the same time wait for it.
+        struct FixtureEntry {
+            AccTestFixtureScope Scope = AccTestFixtureScope::Suite;
+            const std::type_info* Type = nullptr;
+            std::function<std::shared_ptr<void>()> Create;
+            std::mutex Mutex;
+            std::size_t Remaining = 0;
+            std::map<std::size_t, std::shared_ptr<void>> Instances;
+        };
+
+        // Counts the scenarios of the run using each fixture.
+        void PrepareFixtures(const std::vector<std::size_t>& scenarios) {
+            for (auto& fixture : m_Fixtures)
+                fixture.second.Remaining = 0;
+            for (auto scenario : scenarios) {
+                for (const auto& name : m_Scenarios[scenario].Info.Fixtures) {
+                    auto fixture = m_Fixtures.find(name);
+                    if (fixture == m_Fixtures.end())
+                        throw std::invalid_argument("The scenario " + GetScenarioName(scenario) + " uses the fixture " + name + 
+                                ", which the suite doesn't create.");
+                    ++fixture->second.Remaining;
+                }
+            }
         }
 
-        double GetProgressPercentage() {
-            if (m_NumberOfScenarios == 0 || m_NumberOfStepsInScenario == 0)
+        std::shared_ptr<void> GetFixture(std::size_t scenarioIndex, std::size_t worker, const std::string& name,
+                const std::type_info& type) {
+            const auto& declared = m_Scenarios[scenarioIndex].Info.Fixtures;
+            if (std::find(declared.begin(), declared.end(), name) == declared.end())
+                throw std::logic_error("The fixture " + name + " isn't listed in the AccTestScenarioInfo of the scenario.");
+            auto& fixture = m_Fixtures.at(name);
+            if (*fixture.Type != type)
+                throw std::logic_error("The fixture " + name + " is of a different type.");
+            std::lock_guard<std::mutex> lock(fixture.Mutex);
+            auto& instance = fixture.Instances[fixture.Scope == AccTestFixtureScope::Worker ? worker : 0];
+            if (!instance)
+                instance = fixture.Create();
+            return instance;
+        }
+
+        // Lets go of the fixtures no scenario of the run is going to use any more.
+        void ReleaseFixtures(std::size_t scenarioIndex) {
+            for (const auto& name : m_Scenarios[scenarioIndex].Info.Fixtures) {
+                auto& fixture = m_Fixtures.at(name);
+                std::map<std::size_t, std::shared_ptr<void>> released;
+                std::lock_guard<std::mutex> lock(fixture.Mutex);
+                if (fixture.Remaining > 0 && --fixture.Remaining == 0)
+                    released.swap(fixture.Instances);
+            }
+        }
+
+        void ReleaseFixtures() {
+            for (auto& fixture : m_Fixtures)
+                fixture.second.Instances.clear();
+        }
+
+        // Scenarios using the same fixtures share a group, so that the pools can run them on the same worker; every other 
+        // scenario is a group of its own.
+        std::vector<std::size_t> GetFixtureGroups(const std::vector<std::size_t>& scenarios) {
+            std::map<std::set<std::string>, std::size_t> groupOfFixtures;
+            std::vector<std::size_t> groups;
+            std::size_t numberOfGroups = 0;
+            for (auto scenario : scenarios) {
+                const auto& fixtures = m_Scenarios[scenario].Info.Fixtures;
+                if (fixtures.empty()) {
+                    groups.push_back(numberOfGroups++);
+                    continue;
+                }
+                auto group = groupOfFixtures.insert(std::make_pair(std::set<std::string>(fixtures.begin(), fixtures.end()),
+                        numberOfGroups));
+                if (group.second)
+                    ++numberOfGroups;
+                groups.push_back(group.first->second);
+            }
+            return groups;
+        }
+
+        std::vector<std::size_t> SelectScenarios() {
+            if (m_Options.ShardCount == 0 || m_Options.ShardIndex >= m_Options.ShardCount)
+                throw std::invalid_argument("The shard index must be less than the shard count.");
+            AccTestNameFilter scenarioFilter(m_Options.ScenarioFilter), tagFilter(m_Options.TagFilter);
+            AccTestNameFilter stepFilter(m_Options.StepFilter);
+            std::vector<std::size_t> matching;
+            for (std::size_t index = 0; index < m_Scenarios.size(); ++index) {
+                if ((scenarioFilter.IsEmpty() || scenarioFilter.Matches(GetScenarioName(index))) &&
+                        tagFilter.MatchesAny(m_Scenarios[index].Info.Tags))
+                    matching.push_back(index);
+            }
+            std::vector<std::size_t> selected;
+            for (std::size_t index = m_Options.ShardIndex; index < matching.size(); index += m_Options.ShardCount) {
+                // Scenarios that can't be constructed are kept, so that the run reports them.
+                std::string error;
+                auto scenario = stepFilter.IsEmpty() ? nullptr : ConstructScenario(matching[index], error);
+                if (stepFilter.IsEmpty() || !scenario || stepFilter.MatchesAny(scenario->GetStepNames()))
+                    selected.push_back(matching[index]);
+            }
+            return selected;
+        }
+
+        // Fisher-Yates driven by the raw output of std::mt19937, which unlike the standard distributions is specified exactly, 
+        // so a seed gives the same order with every standard library.
+        static void Shuffle(std::vector<std::size_t>& scenarios, unsigned long seed) {
+            std::mt19937 generator(static_cast<std::mt19937::result_type> (seed));
+            for (auto remaining = scenarios.size(); remaining > 1; --remaining)
+                std::swap(scenarios[remaining - 1], scenarios[generator() % remaining]);
+        }
+
+        // Scenarios created without a name that haven't been constructed in this process yet are constructed once to find it 
+        // out. A scenario that can't be constructed is named after its position in the suite.
+        const std::string& GetScenarioName(std::size_t scenarioIndex) {
+            auto& info = m_Scenarios[scenarioIndex].Info;
+            std::string error;
+            if (info.Name.empty() && !ConstructScenario(scenarioIndex, error)) {
+                std::lock_guard<std::mutex> lock(m_DescriptionMutex);
+                info.Name = "Scenario " + std::to_string(scenarioIndex + 1);
+            }
+            return info.Name;
+        }
+
+        // Returns null and the message of the exception if the constructor of the scenario throws, so that the exception 
+        // doesn't end the run, or escape a worker thread or process, wherever the scenario is constructed.
+        std::shared_ptr<AccTestScenarioBase> ConstructScenario(std::size_t scenarioIndex, std::string& error) {
+            try {
+                auto scenario = m_Scenarios[scenarioIndex].Create();
+                Describe(scenarioIndex, *scenario);
+                return scenario;
+            } catch (const std::exception& exception) {
+                error = exception.what();
+            } catch (...) {
+                error = "unknown exception";
+            }
+            return nullptr;
+        }
+
+        // Constructs, runs, and destroys the scenario; returns how long it took to run. The worker running the scenario picks 
+        // the instances of per-worker fixtures it gets. A scenario that can't be constructed is reported as terminated by an 
+        // exception, with the message of the exception in place of its description.
+        double RunScenario(std::size_t scenarioIndex, const std::shared_ptr<AccTestObserverIface>& testObserver,
+                std::size_t worker = 0) {
+            std::string error;
+            auto scenario = ConstructScenario(scenarioIndex, error);
+            if (!scenario) {
+                testObserver->StartingScenario(GetScenarioName(scenarioIndex), "Constructing the scenario threw: " + error, 0);
+                testObserver->ExceptionInScenario();
+                testObserver->FinishedScenario();
+                ReleaseFixtures(scenarioIndex);
                 return 0;
-            auto currentStepIndexNonZero = std::max(m_CurrentStepIndex, static_cast<std::size_t> (1));
-            auto currentScenarioProgress = static_cast<double> (currentStepIndexNonZero - 1) / m_NumberOfStepsInScenario;
-            return (m_CurrentScenarioIndex - 1 + currentScenarioProgress) / m_NumberOfScenarios * 100;
+            }
+            scenario->SetCheckpointOptions(m_Options.Checkpoints);
+            scenario->SetBaselineOptions(m_Options.Baselines);
+            scenario->SetFixtureProvider([this, scenarioIndex, worker](const std::string& name, const std::type_info& type) {
+                return GetFixture(scenarioIndex, worker, name, type); });
+            auto start = std::chrono::steady_clock::now();
+            scenario->Run(testObserver);
+            auto duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            scenario.reset();
+            ReleaseFixtures(scenarioIndex);
+            return duration;
         }
-    private:
-        std::ostream& m_OutputStream;
-        std::size_t m_CurrentScenarioIndex = 0;
-        std::size_t m_NumberOfScenarios = 0;
-        std::size_t m_NumberOfScenariosFailed = 0;
-        std::size_t m_NumberOfScenariosTerminated = 0;
-        std::size_t m_CurrentStepIndex = 0;
-        std::size_t m_NumberOfStepsInScenario = 0;
-        std::size_t m_NumberOfStepsPassed = 0;
-        std::size_t m_NumberOfStepsFailed = 0;
-        bool m_StepPassed = true;
+
+        void RunConcurrently(const std::vector<std::size_t>& scenarios, std::size_t numberOfJobs, std::vector<double>& durations) {
+            std::mutex observerMutex;
+            AccTestWorkerPool pool(std::min(numberOfJobs, scenarios.size()));
+            pool.SetTaskGroups(GetFixtureGroups(scenarios));
+            pool.Run(scenarios.size(), [this, &scenarios, &durations, &observerMutex](std::size_t taskIndex, std::size_t worker) {
+                auto recorder = std::make_shared<AccTestEventRecorder>();
+                durations[taskIndex] = RunScenario(scenarios[taskIndex], recorder, worker);
+                std::lock_guard<std::mutex> lock(observerMutex);
+                recorder->Replay(*m_TestObs);
+            });
+        }
+
+        std::vector<double> RunInWorkerProcesses(const std::vector<std::size_t>& scenarios, std::size_t numberOfJobs) {
+#ifdef ACC_TEST_POSIX
+            AccTestProcessPool pool(numberOfJobs);
+            pool.SetTimeout(m_Options.ScenarioTimeout);
+            pool.SetTaskGroups(GetFixtureGroups(scenarios));
+            return pool.Run(scenarios.size(), [this, &scenarios](std::size_t taskIndex, AccTestObserverIface& observer) {
+                RunScenario(scenarios[taskIndex], std::shared_ptr<AccTestObserverIface>(&observer, [](AccTestObserverIface*) {
+                }));
+            }, *m_TestObs);
+#else
+            (void) scenarios;
+            (void) numberOfJobs;
+            throw std::runtime_error("Running scenarios in worker processes is not supported on this platform.");
+#endif
+        }
+
+        // Runs the scenarios serially, then goes through those that failed. A failed scenario is first run on its own and 
+        // after all the scenarios that preceded it, each in a fresh process forked before any scenario ran; unless it passes 
+        // on its own and fails again after the others, it is left alone. Otherwise the preceding scenarios are narrowed down
+        // by delta debugging.
+        void RunAndBisect(const std::vector<std::size_t>& scenarios, std::size_t numberOfJobs, std::vector<double>& durations) {
+#ifdef ACC_TEST_POSIX
+            AccTestForkServer forkServer([this](const std::vector<std::size_t>& sequence) {
+                return RunSequence(sequence); });
+            std::vector<bool> passed(scenarios.size());
+            for (std::size_t index = 0; index < scenarios.size(); ++index) {
+                auto verdict = std::make_shared<AccTestVerdictObserver>();
+                auto observers = std::make_shared<AccTestObserverGroup>();
+                observers->Add(m_TestObs);
+                observers->Add(verdict);
+                durations[index] = RunScenario(scenarios[index], observers);
+                passed[index] = verdict->HasPassed();
+            }
+            for (std::size_t position = 1; position < scenarios.size(); ++position) {
+                if (passed[position])
+                    continue;
+                auto failing = scenarios[position];
+                std::vector<std::size_t> preceding(scenarios.begin(), scenarios.begin() + position);
+                auto reproduced = forkServer.Run({ {failing}, WithLast(preceding, failing) }, numberOfJobs);
+                if (!reproduced[0] || reproduced[1])
+                    continue;
+                AccTestOrderDependency dependency;
+                dependency.Scenario = GetScenarioName(failing);
+                for (auto culprit : Minimize(forkServer, preceding, failing, numberOfJobs))
+                    dependency.PrecedingScenarios.push_back(GetScenarioName(culprit));
+                m_OrderDependencies.push_back(dependency);
+            }
+#else
+            (void) scenarios;
+            (void) numberOfJobs;
+            (void) durations;
+            throw std::runtime_error("Bisecting order dependencies is not supported on this platform.");
+#endif
+        }
+
+#ifdef ACC_TEST_POSIX
+        // The ddmin algorithm: the scenarios are split into parts, and the failing scenario is run after each part and, with
+        // more than two parts, after each complement, all at once. The first of these that makes it fail replaces the set; if
+        // none does, the parts are made smaller until they are single scenarios. The set returned makes the scenario fail and 
+        // none of its scenarios can be left out.
+        std::vector<std::size_t> Minimize(AccTestForkServer& forkServer, std::vector<std::size_t> culprits, std::size_t failing,
+                std::size_t numberOfJobs) {
+            std::size_t numberOfParts = 2;
+            while (culprits.size() >= 2) {
+                numberOfParts = std::min(numberOfParts, culprits.size());
+                std::vector< std::vector<std::size_t> > parts(numberOfParts), complements(numberOfParts);
+                for (std::size_t index = 0; index < culprits.size(); ++index) {
+                    auto part = index * numberOfParts / culprits.size();
+                    for (std::size_t other = 0; other < numberOfParts; ++other)
+                        (other == part ? parts : complements)[other].push_back(culprits[index]);
+                }
+                std::vector< std::vector<std::size_t> > candidates;
+                for (const auto& part : parts)
+                    candidates.push_back(WithLast(part, failing));
+                if (numberOfParts > 2) {
+                    for (const auto& complement : complements)
+                        candidates.push_back(WithLast(complement, failing));
+                }
+                auto results = forkServer.Run(candidates, numberOfJobs);
+                auto firstFailure = static_cast<std::size_t> (std::find(results.begin(), results.end(), false) - results.begin());
+                if (firstFailure < numberOfParts) {
+                    culprits = parts[firstFailure];
+                    numberOfParts = 2;
+                } else if (firstFailure < results.size()) {
+                    culprits = complements[firstFailure - numberOfParts];
+                    numberOfParts = std::max(numberOfParts - 1, static_cast<std::size_t> (2));
+                } else if (numberOfParts < culprits.size())
+                    numberOfParts *= 2;
+                else
+                    break;
+            }
+            return culprits;
+        }
+
+        static std::vector<std::size_t> WithLast(std::vector<std::size_t> scenarios, std::size_t last) {
+            scenarios.push_back(last);
+            return scenarios;
+        }
+
+        // Runs in a process of the fork server and tells whether the last of the scenarios passed.
+        bool RunSequence(const std::vector<std::size_t>& scenarios) {
+            auto verdict = std::make_shared<AccTestVerdictObserver>();
+            for (auto scenario : scenarios) {
+                verdict = std::make_shared<AccTestVerdictObserver>();
+                RunScenario(scenario, verdict);
+            }
+            return verdict->HasPassed();
+        }
+#endif
+
+        std::vector<ScenarioEntry> m_Scenarios;
+        std::map<std::string, FixtureEntry> m_Fixtures;
+        std::shared_ptr<AccTestObserverIface> m_TestObs;
+        AccTestSuiteOptions m_Options;
+        std::vector<AccTestOrderDependency> m_OrderDependencies;
+        std::mutex m_DescriptionMutex;
     };
 
-    // In most cases you have more than one test scenario with sequential steps that has its own starting point, steps, and cleanup.
-    // To accommodate these situations you can use a test suite which is basically a collection of unrelated test scenarios. Simply
-    // inherit AccTestSuite and, within your constructor, create and add your test scenarios using calls to AddScenario. Afterwards,
-    // you can run all the scenarios in the test suite by a call to the Run method. This executes all the scenarios in the same 
-    // order as they were added. The order shouldn't matter as the test scenarios are supposed to be unrelated, i.e., each scenario
-    // has its own Setup which is supposed to set the preconditions regardless of anything else that might have happened before.
-    // The Run method returns the complete report for all the test scenarios within the suite.
+    // A test suite whose observer type is fixed at compile time, so every event reaches the observer by a direct call 
+    // instead of a virtual one, e.g. AccTestStaticSuite< AccTestObserverList<MyCounter, AccTestObserver> >. Scenarios are 
+    // added with CreateScenario as in AccTestSuite and run one after the other in the order they were added, each one 
+    // constructed right before it runs. Only the checkpoint and baseline options apply; parallel and isolated runs, sharding,
+    // and filtering remain with AccTestSuite, which reports through AccTestObserverIface.
 
-    class AccTestSuite {
+    template <typename ObserverType>
+    class AccTestStaticSuite {
     public:
 
-        AccTestSuite()
-        : m_TestObs(std::make_shared<AccTestObserver>(std::cout)) {
+        void SetOptions(const AccTestSuiteOptions& options) {
+            m_Options = options;
         }
 
-        void SetTestObserver(std::shared_ptr<AccTestObserverIface> testObs) {
-            m_TestObs = testObs;
+        const AccTestSuiteOptions& GetOptions() {
+            return m_Options;
         }
 
-        void Run() {
-            m_TestObs->StartingTestSuite(m_Scenarios.size());
-            for (auto test : m_Scenarios)
-                test->Run(m_TestObs);
-            m_TestObs->FinishedTestSuite();
+        void Run(ObserverType& testObserver) {
+            testObserver.StartingTestSuite(m_Scenarios.size());
+            for (const auto& runScenario : m_Scenarios)
+                runScenario(testObserver, m_Options);
+            testObserver.FinishedTestSuite();
         }
 
     protected:
 
         template <class ScenType, class... Args>
         void CreateScenario(Args... constructionArgs) {
-            m_Scenarios.push_back(std::make_shared<ScenType>(constructionArgs...));
+            m_Scenarios.push_back([constructionArgs...](ObserverType& testObserver, const AccTestSuiteOptions& options) {
+                ScenType scenario(constructionArgs...);
+                scenario.SetCheckpointOptions(options.Checkpoints);
+                scenario.SetBaselineOptions(options.Baselines);
+                scenario.RunWith(testObserver);
+            });
         }
 
     private:
-        std::vector< std::shared_ptr<AccTestScenarioBase> > m_Scenarios;
-        std::shared_ptr<AccTestObserverIface> m_TestObs;
+        std::vector< std::function<void(ObserverType&, const AccTestSuiteOptions&)> > m_Scenarios;
+        AccTestSuiteOptions m_Options;
+    };
+
+    // Splits the command line of the test program into options. Each option is written either as --name=value or as 
+    // --name value; an option that is not followed by a value is a flag and gets an empty value. Options are taken out by name 
+    // as they are consumed, and most of them can alternatively be given through an environment variable, which the command 
+    // line overrides. Whatever is left once all known options have been taken is reported as unknown. A value that starts with
+    // a dash, such as a filter with negative patterns only, is best written as --name=value.
+    // The most common options also have a single-letter form (see GetShortOptions), which stands for the long option. Its 
+    // value, if the option takes one, is either attached, as in -j4, or the next argument, as in -j 4. An option whose value 
+    // is optional, such as -s, only takes the next argument if that isn't an option itself, so -s -q shuffles with a random 
+    // seed and runs quietly.
+
+    class AccTestCommandLine {
+    public:
+
+        AccTestCommandLine(int argc, char** argv) {
+            for (int index = 1; index < argc; ++index) {
+                std::string argument = argv[index];
+                auto shortOption = FindShortOption(argument);
+                if (shortOption) {
+                    if (argument.size() > 2)
+                        m_Options[shortOption->Name] = argument.substr(2);
+                    else if (shortOption->Value)
+                        m_Options[shortOption->Name] = shortOption->Value;
+                    else if (index + 1 < argc && (!shortOption->ValueIsOptional || argv[index + 1][0] != '-'))
+                        m_Options[shortOption->Name] = argv[++index];
+                    else
+                        m_Options[shortOption->Name] = "";
+                    continue;
+                }
+                if (argument.compare(0, 2, "--") != 0) {
+                    m_UnknownArguments.push_back(argument);
+                    continue;
+                }
+                auto separator = argument.find('=');
+                if (separator != std::string::npos)
+                    m_Options[argument.substr(2, separator - 2)] = argument.substr(separator + 1);
+                else if (index + 1 < argc && std::string(argv[index + 1]).compare(0, 2, "--") != 0 &&
+                        !FindShortOption(argv[index + 1]))
+                    m_Options[argument.substr(2)] = argv[++index];
+                else
+                    m_Options[argument.substr(2)] = "";
+            }
+        }
+
+        struct ShortOption {
+            char Letter;
+            const char* Name;
+            const char* Value; // The value implied by the letter, or nullptr if it is given one.
+            bool ValueIsOptional; // The next argument is only taken as the value if it isn't an option.
+        };
+
+        static const std::vector<ShortOption>& GetShortOptions() {
+            static const std::vector<ShortOption> shortOptions = {
+                {'h', "help", "", false}, {'j', "jobs", nullptr, false}, {'f', "filter", nullptr, false}, 
+                {'t', "tags", nullptr, false}, {'r', "repeat", nullptr, false}, {'s', "shuffle", nullptr, true}, 
+                {'i', "isolate", "", false}, {'q', "verbosity", "quiet", false}, {'o', "output", nullptr, false}
+            };
+            return shortOptions;
+        }
+
+        bool Take(const std::string& name, std::string& value, const char* environmentVariable = nullptr) {
+            auto option = m_Options.find(name);
+            if (option != m_Options.end()) {
+                value = option->second;
+                m_Options.erase(option);
+                return true;
+            }
+            auto environmentValue = environmentVariable ? std::getenv(environmentVariable) : nullptr;
+            if (environmentValue && *environmentValue) {
+                value = environmentValue;
+                return true;
+            }
+            return false;
+        }
+
+        bool TakeSize(const std::string& name, std::size_t& value, const char* environmentVariable = nullptr) {
+            std::string text;
+            if (!Take(name, text, environmentVariable))
+                return false;
+            std::istringstream input(text);
+            unsigned long long number;
+            if (text.empty() || text[0] == '-' || !(input >> number) || !input.eof())
+                throw std::invalid_argument("Invalid value for --" + name + ": \"" + text + "\"");
+            value = static_cast<std::size_t> (number);
+            return true;
+        }
+
+        bool TakeDouble(const std::string& name, double& value, const char* environmentVariable = nullptr) {
+            std::string text;
+            if (!Take(name, text, environmentVariable))
+                return false;
+            std::istringstream input(text);
+            if (text.empty() || !(input >> value) || !input.eof())
+                throw std::invalid_argument("Invalid value for --" + name + ": \"" + text + "\"");
+            return true;
+        }
+
+        // A flag given without a value is turned on.
+        bool TakeFlag(const std::string& name, bool& value, const char* environmentVariable = nullptr) {
+            std::string text;
+            if (!Take(name, text, environmentVariable))
+                return false;
+            value = text.empty() || text == "1" || text == "true";
+            return true;
+        }
+
+        std::vector<std::string> GetUnknownArguments() {
+            auto unknown = m_UnknownArguments;
+            for (const auto& option : m_Options)
+                unknown.push_back("--" + option.first);
+            return unknown;
+        }
+
+    private:
+
+        // Matches -x, and -xVALUE for the options that are given a value.
+        static const ShortOption* FindShortOption(const std::string& argument) {
+            if (argument.size() < 2 || argument[0] != '-')
+                return nullptr;
+            for (const auto& shortOption : GetShortOptions()) {
+                if (shortOption.Letter == argument[1])
+                    return argument.size() == 2 || !shortOption.Value ? &shortOption : nullptr;
+            }
+            return nullptr;
+        }
+
+        std::map<std::string, std::string> m_Options;
+        std::vector<std::string> m_UnknownArguments;
     };
 
     // In the main() function of your test executable you will probably have an instance of AccTestRunner specialized with your 
-    // test suite class. AccTestRunner is supposed to take care of you argc and argv. Currently it simply throws them away!
+    // test suite class. AccTestRunner takes care of your argc and argv; the options it understands are listed by --help (see 
+    // PrintUsage below), most of them with an environment variable that can be used instead. They let the same test program
+    // do a quick local run, e.g. -j 8 -f "Login*" -q, as well as a thorough CI run with repeats, shuffling, isolation, 
+    // timeouts, and result files.
     // You main() function will then call the Run() method and everything else taken care of: like all the test suite is run, and
-    // the report passed to the report formatter and printed out to standard output.
+    // the report passed to the report formatter and printed out to standard output. The value returned by Run() is the number
+    // of scenarios that did not pass, which makes a suitable exit code for the test program.
+    // Run can also be given a test suite constructed elsewhere, and the runner can write to other streams than the standard 
+    // output and error; AccTestSuiteHost uses both to run a suite loaded from a shared library over and over again.
 
     template <class T = AccTestSuite>
     class AccTestRunner {
     public:
         typedef T TestSuiteType;
 
-        AccTestRunner(int argc, char** argv) {
+        AccTestRunner(int argc, char** argv, std::ostream& output = std::cout, std::ostream& errorOutput = std::cerr)
+        : m_CommandLine(argc, argv), m_ProgramName(argc > 0 ? argv[0] : "test"), m_Output(output), m_ErrorOutput(errorOutput) {
+            if (argc > 0)
+                AccTestFingerprint::SetExecutablePath(argv[0]);
         }
 
         int Run() {
-            auto testObserver = std::make_shared<AccTestObserver>(std::cout);
             TestSuiteType testSuite;
-            testSuite.SetTestObserver(testObserver);
+            return Run(testSuite);
+        }
+
+        int Run(TestSuiteType& testSuite) {
+            bool help = false;
+            if (m_CommandLine.TakeFlag("help", help) && help) {
+                PrintUsage(m_Output, m_ProgramName);
+                return 0;
+            }
+            std::string mergedResultFiles;
+            if (m_CommandLine.Take("merge-results", mergedResultFiles))
+                return MergeResults(mergedResultFiles);
+            std::ostream discardedOutput(nullptr);
+            std::ofstream outputFile;
+            std::ofstream binaryLogFile;
+            std::ofstream traceFile;
+            std::ostream* output = &m_Output;
+            std::shared_ptr<AccTestObserver> testObserver;
+            bool printTotalsOnly = false;
+            std::string resultFile;
+            try {
+                auto options = testSuite.GetOptions();
+                m_CommandLine.TakeSize("jobs", options.NumberOfJobs, "PROTEST_JOBS");
+                m_CommandLine.TakeSize("shard-count", options.ShardCount, "PROTEST_SHARD_COUNT");
+                m_CommandLine.TakeSize("shard-index", options.ShardIndex, "PROTEST_SHARD_INDEX");
+                m_CommandLine.Take("filter", options.ScenarioFilter, "PROTEST_FILTER");
+                m_CommandLine.Take("tags", options.TagFilter, "PROTEST_TAGS");
+                m_CommandLine.Take("step-filter", options.StepFilter, "PROTEST_STEP_FILTER");
+                m_CommandLine.TakeSize("repeat", options.RepeatCount, "PROTEST_REPEAT");
+                if (options.RepeatCount == 0)
+                    throw std::invalid_argument("Invalid value for --repeat: \"0\"");
+                std::string shuffleSeed;
+                if (m_CommandLine.Take("shuffle", shuffleSeed, "PROTEST_SHUFFLE")) {
+                    options.ShuffleScenarios = true;
+                    std::istringstream input(shuffleSeed);
+                    if (shuffleSeed.empty())
+                        options.ShuffleSeed = std::random_device()();
+                    else if (shuffleSeed[0] == '-' || !(input >> options.ShuffleSeed) || !input.eof())
+                        throw std::invalid_argument("Invalid value for --shuffle: \"" + shuffleSeed + "\"");
+                }
+                m_CommandLine.Take("checkpoint-dir", options.Checkpoints.Directory, "PROTEST_CHECKPOINT_DIR");
+                std::string resumeFrom;
+                if (m_CommandLine.Take("resume-from", resumeFrom) && resumeFrom == "latest")
+                    options.Checkpoints.ResumeFromStep = AccTestCheckpointOptions::ResumeFromLatest;
+                else if (!resumeFrom.empty()) {
+                    std::istringstream input(resumeFrom);
+                    if (!(input >> options.Checkpoints.ResumeFromStep) || !input.eof())
+                        throw std::invalid_argument("Invalid value for --resume-from: \"" + resumeFrom + "\"");
+                }
+                m_CommandLine.TakeFlag("isolate", options.IsolateScenarios, "PROTEST_ISOLATE");
+                double timeout = 0;
+                m_CommandLine.TakeDouble("timeout", timeout, "PROTEST_TIMEOUT");
+                if (timeout < 0)
+                    throw std::invalid_argument("The timeout must not be negative.");
+                options.ScenarioTimeout = std::chrono::duration_cast<AccTestClock::duration>(std::chrono::duration<double>(timeout));
+                m_CommandLine.TakeFlag("bisect", options.BisectOrderDependencies, "PROTEST_BISECT");
+                if (options.BisectOrderDependencies && (options.IsolateScenarios || timeout > 0))
+                    throw std::invalid_argument("--bisect runs the scenarios in this process; it can't be combined with "
+                            "--isolate or --timeout.");
+                bool asyncOutput = false;
+                m_CommandLine.TakeFlag("async-output", asyncOutput, "PROTEST_ASYNC_OUTPUT");
+                bool failureOnlyOutput = false;
+                m_CommandLine.TakeFlag("failure-only-output", failureOnlyOutput, "PROTEST_FAILURE_ONLY_OUTPUT");
+                std::string verbosity = failureOnlyOutput ? "failures" : "normal";
+                m_CommandLine.Take("verbosity", verbosity, "PROTEST_VERBOSITY");
+                if (verbosity != "quiet" && verbosity != "failures" && verbosity != "normal" && verbosity != "detailed")
+                    throw std::invalid_argument("Invalid value for --verbosity: \"" + verbosity + "\"");
+                std::string outputPath;
+                m_CommandLine.Take("output", outputPath, "PROTEST_OUTPUT");
+                std::string binaryLog;
+                m_CommandLine.Take("binary-log", binaryLog, "PROTEST_BINARY_LOG");
+                std::string trace;
+                m_CommandLine.Take("trace", trace, "PROTEST_TRACE");
+                m_CommandLine.Take("baseline-dir", options.Baselines.Directory, "PROTEST_BASELINE_DIR");
+                m_CommandLine.TakeFlag("update-baselines", options.Baselines.Update, "PROTEST_UPDATE_BASELINES");
+                m_CommandLine.TakeDouble("baseline-threshold", options.Baselines.Threshold, "PROTEST_BASELINE_THRESHOLD");
+                m_CommandLine.TakeDouble("baseline-significance", options.Baselines.Significance, 
+                        "PROTEST_BASELINE_SIGNIFICANCE");
+                m_CommandLine.Take("result-file", resultFile, "PROTEST_RESULT_FILE");
+                m_CommandLine.Take("duration-history", options.DurationHistoryFile, "PROTEST_DURATION_HISTORY");
+                m_CommandLine.Take("result-cache", options.ResultCacheFile, "PROTEST_RESULT_CACHE");
+                m_CommandLine.Take("cache-fingerprint", options.ResultCacheFingerprint, "PROTEST_CACHE_FINGERPRINT");
+                m_CommandLine.TakeFlag("force-run", options.ForceRun, "PROTEST_FORCE_RUN");
+                if (options.ShardCount == 0 || options.ShardIndex >= options.ShardCount)
+                    throw std::invalid_argument("The shard index must be less than the shard count.");
+                for (const auto& filter : {options.ScenarioFilter, options.TagFilter, options.StepFilter})
+                    AccTestNameFilter validatedFilter(filter);
+                RejectUnknownArguments();
+                testSuite.SetOptions(options);
+                if (!outputPath.empty()) {
+                    outputFile.open(outputPath.c_str());
+                    if (!outputFile)
+                        throw std::invalid_argument("Unable to create the output file " + outputPath);
+                    output = &outputFile;
+                }
+                printTotalsOnly = verbosity == "quiet" || !binaryLog.empty();
+                testObserver = std::make_shared<AccTestObserver>(printTotalsOnly ? discardedOutput : *output);
+                testObserver->SetFailureOnlyOutput(verbosity == "failures");
+                testObserver->SetStepTimingOutput(verbosity == "detailed");
+                std::shared_ptr<AccTestObserverIface> reportingObserver = testObserver;
+                if (!binaryLog.empty() || !trace.empty()) {
+                    auto observerGroup = std::make_shared<AccTestObserverGroup>();
+                    observerGroup->Add(testObserver);
+                    if (!binaryLog.empty()) {
+                        binaryLogFile.open(binaryLog.c_str(), std::ios::binary);
+                        if (!binaryLogFile)
+                            throw std::invalid_argument("Unable to create the binary log file " + binaryLog);
+                        observerGroup->Add(std::make_shared<AccTestBinaryLogObserver>(binaryLogFile));
+                    }
+                    if (!trace.empty()) {
+                        traceFile.open(trace.c_str());
+                        if (!traceFile)
+                            throw std::invalid_argument("Unable to create the trace file " + trace);
+                        observerGroup->Add(std::make_shared<AccTestTraceObserver>(traceFile));
+                    }
+                    reportingObserver = observerGroup;
+                }
+                if (asyncOutput)
+                    reportingObserver = std::make_shared<AccTestAsyncObserver>(reportingObserver);
+                testSuite.SetTestObserver(reportingObserver);
+                if (options.ShuffleScenarios)
+                    *output << "Shuffling the scenarios with seed " << options.ShuffleSeed << " (--shuffle=" << 
+                            options.ShuffleSeed << " repeats the order)" << '\n';
+            } catch (const std::invalid_argument& error) {
+                m_ErrorOutput << error.what() << std::endl;
+                return -1;
+            }
             testSuite.Run();
-            return testObserver->GetNumberOfScenarios() - testObserver->GetNumberOfScenariosPassed();
+            auto summary = testObserver->GetSummary();
+            if (printTotalsOnly)
+                AccTestObserver::PrintSummary(*output, summary);
+            if (testSuite.GetOptions().BisectOrderDependencies)
+                PrintOrderDependencies(*output, testSuite.GetOrderDependencies());
+            output->flush();
+            if (!resultFile.empty()) {
+                std::ofstream resultOutput(resultFile.c_str());
+                summary.WriteTo(resultOutput);
+            }
+            return static_cast<int> (summary.NumberOfScenarios - summary.GetNumberOfScenariosPassed());
+        }
+
+        static void PrintUsage(std::ostream& output, const std::string& programName) {
+            output << "Usage: " << programName << " [OPTION]..." << '\n' <<
+                "Runs the acceptance test suite; the exit code is the number of scenarios that didn't pass. Most options can\n"
+                "also be given through the environment variable in parentheses. Short options take their value attached, as in\n"
+                "-j4, or as the next argument, as in -j 4.\n"
+                "\n"
+                "Selecting and scheduling scenarios:\n"
+                "  -f, --filter=FILTER             run only the scenarios whose names pass FILTER, e.g. \"Login*-*Slow\"\n"
+                "                                  (PROTEST_FILTER; see AccTestNameFilter)\n"
+                "  -t, --tags=FILTER               run only the scenarios with a tag passing FILTER (PROTEST_TAGS)\n"
+                "      --step-filter=FILTER        run only the scenarios with a step whose name passes FILTER\n"
+                "                                  (PROTEST_STEP_FILTER)\n"
+                "      --shard-count=N             split the suite into N shards... (PROTEST_SHARD_COUNT)\n"
+                "      --shard-index=I             ...and run only shard I, from 0 to N - 1 (PROTEST_SHARD_INDEX)\n"
+                "  -r, --repeat=N                  run each scenario N times (PROTEST_REPEAT)\n"
+                "  -s, --shuffle[=SEED]            run the scenarios in a random order, reproducible with the seed printed\n"
+                "                                  (PROTEST_SHUFFLE=SEED)\n"
+                "  -j, --jobs=N                    number of scenarios run concurrently, 0 for one per hardware thread\n"
+                "                                  (PROTEST_JOBS)\n"
+                "  -i, --isolate                   run the scenarios in worker processes so crashes don't end the run\n"
+                "                                  (PROTEST_ISOLATE=1)\n"
+                "      --timeout=SECONDS           kill scenarios running longer than this; implies --isolate\n"
+                "                                  (PROTEST_TIMEOUT)\n"
+                "      --duration-history=PATH     remember scenario durations in PATH and run the longest first\n"
+                "                                  (PROTEST_DURATION_HISTORY)\n"
+                "      --bisect                    run the scenarios serially, then find the scenarios run before each\n"
+                "                                  failed one that make it fail; combine with --shuffle (PROTEST_BISECT=1)\n"
+                "      --result-cache=PATH         remember the scenarios that pass in PATH and don't run them again until\n"
+                "                                  the test program or their steps change (PROTEST_RESULT_CACHE)\n"
+                "      --cache-fingerprint=TEXT    tell test programs apart by TEXT rather than by the hash of the\n"
+                "                                  executable (PROTEST_CACHE_FINGERPRINT)\n"
+                "      --force-run                 run the scenarios that passed before too, and update the cache\n"
+                "                                  (PROTEST_FORCE_RUN=1)\n"
+                "\n"
+                "Reporting:\n"
+                "  -o, --output=PATH               write the report to PATH instead of the standard output (PROTEST_OUTPUT)\n"
+                "      --verbosity=LEVEL           normal: the whole report; detailed: the whole report and the duration\n"
+                "                                  of every step; failures: the log of failed steps and scenarios only;\n"
+                "                                  quiet: the totals only (PROTEST_VERBOSITY)\n"
+                "  -q                              the same as --verbosity=quiet\n"
+                "      --failure-only-output       the same as --verbosity=failures (PROTEST_FAILURE_ONLY_OUTPUT=1)\n"
+                "      --async-output              format and write the report on a background thread\n"
+                "                                  (PROTEST_ASYNC_OUTPUT=1)\n"
+                "      --binary-log=PATH           write the report to PATH as a binary log and only print the totals;\n"
+                "                                  AccTestLogDecoder turns the log back into the report (PROTEST_BINARY_LOG)\n"
+                "      --trace=PATH                write the timeline of the run to PATH as a Chrome trace (PROTEST_TRACE)\n"
+                "      --result-file=PATH          store the totals of the run in PATH (PROTEST_RESULT_FILE)\n"
+                "      --merge-results=PATH[,PATH...]\n"
+                "                                  instead of running the suite, add up result files and print the totals\n"
+                "\n"
+                "Checkpoints and baselines:\n"
+                "      --checkpoint-dir=PATH       save scenario checkpoints in the existing directory PATH\n"
+                "                                  (PROTEST_CHECKPOINT_DIR)\n"
+                "      --resume-from=STEP|latest   skip the steps before STEP using the latest checkpoint saved before it\n"
+                "      --baseline-dir=PATH         compare performance checks against the baselines in the existing\n"
+                "                                  directory PATH (PROTEST_BASELINE_DIR)\n"
+                "      --update-baselines          store the timings of this run as the new baselines\n"
+                "                                  (PROTEST_UPDATE_BASELINES=1)\n"
+                "      --baseline-threshold=FRACTION\n"
+                "                                  slowdown of the median tolerated by the baseline checks, 0.1 by default\n"
+                "                                  (PROTEST_BASELINE_THRESHOLD)\n"
+                "      --baseline-significance=P   significance level of the baseline checks, 0.01 by default\n"
+                "                                  (PROTEST_BASELINE_SIGNIFICANCE)\n"
+                "\n"
+                "  -h, --help                      print this help and exit\n";
+        }
+
+    private:
+
+        static void PrintOrderDependencies(std::ostream& output, const std::vector<AccTestOrderDependency>& dependencies) {
+            if (dependencies.empty())
+                output << "No order dependencies found." << '\n';
+            for (const auto& dependency : dependencies) {
+                output << "Order dependency: \"" << dependency.Scenario << "\" fails when run after ";
+                for (std::size_t index = 0; index < dependency.PrecedingScenarios.size(); ++index)
+                    output << (index ? ", \"" : "\"") << dependency.PrecedingScenarios[index] << '"';
+                output << " but passes on its own" << '\n';
+            }
+        }
+
+        void RejectUnknownArguments() {
+            auto unknownArguments = m_CommandLine.GetUnknownArguments();
+            if (!unknownArguments.empty())
+                throw std::invalid_argument("Unknown command line argument: " + unknownArguments.front());
+        }
+
+        int MergeResults(const std::string& resultFiles) {
+            AccTestSummary total;
+            std::istringstream paths(resultFiles);
+            std::string path;
+            while (std::getline(paths, path, ',')) {
+                AccTestSummary summary;
+                std::ifstream input(path.c_str());
+                if (!input || !summary.ReadFrom(input)) {
+                    m_ErrorOutput << "Unable to read test results from " << path << std::endl;
+                    return -1;
+                }
+                total += summary;
+            }
+            AccTestObserver::PrintSummary(m_Output, total);
+            return static_cast<int> (total.NumberOfScenarios - total.GetNumberOfScenariosPassed());
+        }
+
+        AccTestCommandLine m_CommandLine;
+        std::string m_ProgramName;
+        std::ostream& m_Output;
+        std::ostream& m_ErrorOutput;
+    };
+
+#ifdef ACC_TEST_POSIX
+
+    // A test suite compiled into a shared library with ACC_TEST_EXPORT_SUITE and loaded into the running program. The library
+    // is copied to a temporary file and loaded from the copy, so it can be rebuilt in place while it is loaded and loading it
+    // again picks up the new build. Load constructs the suite of the new build before destroying the old one, so a build that 
+    // fails to load leaves the old suite in place.
+    // The suite is constructed once per load and kept until the next one: whatever it sets up in its constructor and keeps in 
+    // its members, or in statics of the library, stays warm between runs. The library has to be built with the same version of
+    // this header as the program loading it. GCC marks the libraries that have statics in inline functions, as this header 
+    // does, as never to be unloaded; build them with -fno-gnu-unique to have old builds unloaded.
+
+    class AccTestSuiteLibrary {
+    public:
+
+        explicit AccTestSuiteLibrary(const std::string& path)
+        : m_Path(path) {
+            Load();
+        }
+
+        ~AccTestSuiteLibrary() {
+            Unload(m_Loaded);
+        }
+
+        AccTestSuiteLibrary(const AccTestSuiteLibrary&) = delete;
+        AccTestSuiteLibrary& operator=(const AccTestSuiteLibrary&) = delete;
+
+        const std::string& GetPath() {
+            return m_Path;
+        }
+
+        AccTestSuite& GetSuite() {
+            return *m_Loaded.Suite;
+        }
+
+        // Tells whether the library file has been replaced or modified since it was loaded.
+        bool HasChanged() {
+            return GetStamp() != m_Loaded.Stamp;
+        }
+
+        void Load() {
+            Loaded loaded;
+            loaded.Stamp = GetStamp();
+            auto copyPath = CopyToTemporaryFile();
+            loaded.Handle = dlopen(copyPath.c_str(), RTLD_NOW | RTLD_LOCAL);
+            unlink(copyPath.c_str());
+            if (!loaded.Handle)
+                throw std::runtime_error("Unable to load " + m_Path + ": " + dlerror());
+            auto createSuite = reinterpret_cast<AccTestSuite* (*)()> (dlsym(loaded.Handle, "ProTestCreateSuite"));
+            loaded.DestroySuite = reinterpret_cast<void (*)(AccTestSuite*)> (dlsym(loaded.Handle, "ProTestDestroySuite"));
+            if (!createSuite || !loaded.DestroySuite) {
+                dlclose(loaded.Handle);
+                throw std::runtime_error(m_Path + " doesn't export a test suite; see ACC_TEST_EXPORT_SUITE.");
+            }
+            try {
+                loaded.Suite = createSuite();
+            } catch (...) {
+                dlclose(loaded.Handle);
+                throw;
+            }
+            Unload(m_Loaded);
+            m_Loaded = loaded;
+        }
+
+    private:
+
+        struct Loaded {
+            void* Handle = nullptr;
+            AccTestSuite* Suite = nullptr;
+            void (*DestroySuite)(AccTestSuite*) = nullptr;
+            std::string Stamp;
+        };
+
+        static void Unload(Loaded& loaded) {
+            if (loaded.Suite)
+                loaded.DestroySuite(loaded.Suite);
+            if (loaded.Handle)
+                dlclose(loaded.Handle);
+            loaded = Loaded();
         }
+
+        // The inode, size and modification time of the library file, which the linker changes when it writes a new build.
+        std::string GetStamp() {
+            struct stat status;
+            if (stat(m_Path.c_str(), &status) != 0)
+                throw std::runtime_error("Unable to find the test suite library " + m_Path);
+            std::ostringstream stamp;
+            stamp << status.st_ino << ' ' << status.st_size << ' ' << status.st_mtime;
+            return stamp.str();
+        }
+
+        std::string CopyToTemporaryFile() {
+            auto directory = std::getenv("TMPDIR");
+            std::string copyPath = std::string(directory && *directory ? directory : "/tmp") + "/ProTestSuite-XXXXXX";
+            auto fd = mkstemp(&copyPath[0]);
+            if (fd < 0)
+                throw std::runtime_error("Unable to create a temporary copy of " + m_Path);
+            close(fd);
+            std::ifstream input(m_Path.c_str(), std::ios::binary);
+            std::ofstream output(copyPath.c_str(), std::ios::binary);
+            output << input.rdbuf();
+            output.close();
+            if (!input || !output) {
+                unlink(copyPath.c_str());
+                throw std::runtime_error("Unable to create a temporary copy of " + m_Path);
+            }
+            return copyPath;
+        }
+
+        std::string m_Path;
+        Loaded m_Loaded;
+    };
+
+    // A stream buffer reading from and writing to a file descriptor, e.g. a socket. Written text is sent on flush.
+
+    class AccTestFileDescriptorBuffer : public std::streambuf {
+    public:
+
+        explicit AccTestFileDescriptorBuffer(int fd)
+        : m_Fd(fd) {
+            setp(m_Output, m_Output + sizeof (m_Output));
+        }
+
+        ~AccTestFileDescriptorBuffer() {
+            sync();
+        }
+
+    protected:
+
+        int_type underflow() override {
+            ssize_t received;
+            do
+                received = read(m_Fd, m_Input, sizeof (m_Input));
+            while (received < 0 && errno == EINTR);
+            if (received <= 0)
+                return traits_type::eof();
+            setg(m_Input, m_Input, m_Input + received);
+            return traits_type::to_int_type(*gptr());
+        }
+
+        int_type overflow(int_type character) override {
+            if (sync() != 0)
+                return traits_type::eof();
+            if (!traits_type::eq_int_type(character, traits_type::eof())) {
+                *pptr() = traits_type::to_char_type(character);
+                pbump(1);
+            }
+            return traits_type::not_eof(character);
+        }
+
+        int sync() override {
+            auto sent = AccTestPipe::WriteAll(m_Fd, std::string(pbase(), pptr()));
+            setp(m_Output, m_Output + sizeof (m_Output));
+            return sent ? 0 : -1;
+        }
+
+    private:
+        int m_Fd;
+        char m_Input[4096];
+        char m_Output[4096];
+    };
+
+    // Keeps a test suite loaded from a shared library (see AccTestSuiteLibrary) and runs it on command, so that neither the 
+    // process nor the suite has to be started again for each run. AccTestSuiteHost.cpp is a program around it. Commands are 
+    // read one per line, from a stream such as the standard input or from the clients of a local Unix socket:
+    //   run [OPTION]...   run the suite with the options of AccTestRunner (run --help lists them); a rebuilt library is 
+    //                     loaded again first
+    //   reload            load the library again
+    //   load PATH         load another library in place of the current one
+    //   quit              stop serving
+    // Arguments are separated by spaces and may be put in double quotes. The reply to each command ends with a line "exit N",
+    // N being the exit code of AccTestRunner for run, 0 for any other command that succeeded and -1 for one that failed. Every 
+    // run starts from the suite options the suite had when it was loaded, and the environment variables of the options apply 
+    // as usual. For checkpoints and --result-cache, it is the hash of the library rather than of the host that tells builds 
+    // apart.
+
+    class AccTestSuiteHost {
+    public:
+
+        explicit AccTestSuiteHost(const std::string& libraryPath)
+        : m_Library(new AccTestSuiteLibrary(libraryPath)), m_DefaultOptions(m_Library->GetSuite().GetOptions()) {
+        }
+
+        // Serves the commands read from input until it ends or a quit command arrives; returns false after quit.
+        bool Serve(std::istream& input, std::ostream& output) {
+            std::string line;
+            while (std::getline(input, line)) {
+                auto arguments = SplitCommand(line);
+                if (arguments.empty())
+                    continue;
+                if (arguments[0] == "quit" && arguments.size() == 1) {
+                    output << "exit 0" << std::endl;
+                    return false;
+                }
+                auto exitCode = Execute(arguments, output);
+                output << "exit " << exitCode << std::endl;
+            }
+            return true;
+        }
+
+        // Listens on a Unix socket created at socketPath and serves its clients one at a time until one sends quit.
+        void ServeSocket(const std::string& socketPath) {
+            sockaddr_un address;
+            std::memset(&address, 0, sizeof (address));
+            if (socketPath.size() >= sizeof (address.sun_path))
+                throw std::runtime_error("The socket path is too long: " + socketPath);
+            address.sun_family = AF_UNIX;
+            socketPath.copy(address.sun_path, socketPath.size());
+            unlink(socketPath.c_str());
+            auto listener = socket(AF_UNIX, SOCK_STREAM, 0);
+            if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*> (&address), sizeof (address)) != 0 || 
+                    listen(listener, 8) != 0) {
+                if (listener >= 0)
+                    close(listener);
+                throw std::runtime_error("Unable to listen on " + socketPath);
+            }
+            // A client that disconnects before reading its reply must not take the host down with it.
+            auto previousSigPipeHandler = std::signal(SIGPIPE, SIG_IGN);
+            auto serving = true;
+            while (serving) {
+                auto connection = accept(listener, nullptr, nullptr);
+                if (connection < 0 && errno == EINTR)
+                    continue;
+                if (connection < 0)
+                    break;
+                {
+                    AccTestFileDescriptorBuffer buffer(connection);
+                    std::istream input(&buffer);
+                    std::ostream output(&buffer);
+                    serving = Serve(input, output);
+                }
+                close(connection);
+            }
+            std::signal(SIGPIPE, previousSigPipeHandler);
+            close(listener);
+            unlink(socketPath.c_str());
+        }
+
+        int Execute(const std::vector<std::string>& arguments, std::ostream& output) {
+            try {
+                if (arguments[0] == "run")
+                    return RunSuite(arguments, output);
+                if (arguments[0] == "reload" && arguments.size() == 1) {
+                    m_Library->Load();
+                    m_DefaultOptions = m_Library->GetSuite().GetOptions();
+                    output << "Loaded " << m_Library->GetPath() << std::endl;
+                    return 0;
+                }
+                if (arguments[0] == "load" && arguments.size() == 2) {
+                    std::unique_ptr<AccTestSuiteLibrary> library(new AccTestSuiteLibrary(arguments[1]));
+                    m_Library = std::move(library);
+                    m_DefaultOptions = m_Library->GetSuite().GetOptions();
+                    output << "Loaded " << m_Library->GetPath() << std::endl;
+                    return 0;
+                }
+                output << "Unknown command: " << arguments[0] << " (run [OPTION]..., reload, load PATH or quit)" << std::endl;
+            } catch (const std::exception& error) {
+                output << error.what() << std::endl;
+            }
+            return -1;
+        }
+
+        static std::vector<std::string> SplitCommand(const std::string& line) {
+            std::vector<std::string> arguments;
+            std::string argument;
+            bool inArgument = false, quoted = false;
+            for (auto character : line) {
+                if (character == '"') {
+                    quoted = !quoted;
+                    inArgument = true;
+                } else if (!quoted && std::isspace(static_cast<unsigned char> (character))) {
+                    if (inArgument)
+                        arguments.push_back(argument);
+                    argument.clear();
+                    inArgument = false;
+                } else {
+                    argument.push_back(character);
+                    inArgument = true;
+                }
+            }
+            if (inArgument)
+                arguments.push_back(argument);
+            return arguments;
+        }
+
+    private:
+
+        int RunSuite(std::vector<std::string> arguments, std::ostream& output) {
+            if (m_Library->HasChanged()) {
+                m_Library->Load();
+                m_DefaultOptions = m_Library->GetSuite().GetOptions();
+                output << "Loaded " << m_Library->GetPath() << " again as it has changed" << std::endl;
+            }
+            arguments[0] = m_Library->GetPath();
+            std::vector<char*> argv;
+            for (auto& argument : arguments)
+                argv.push_back(&argument[0]);
+            argv.push_back(nullptr);
+            auto& suite = m_Library->GetSuite();
+            auto options = m_DefaultOptions;
+            unsigned long long libraryHash = 0;
+            if (AccTestFingerprint::HashFile(m_Library->GetPath(), libraryHash)) {
+                auto libraryFingerprint = AccTestFingerprint::ToHex(libraryHash);
+                if (options.ResultCacheFingerprint.empty())
+                    options.ResultCacheFingerprint = libraryFingerprint;
+                if (options.Checkpoints.ProgramFingerprint.empty())
+                    options.Checkpoints.ProgramFingerprint = libraryFingerprint;
+            }
+            suite.SetOptions(options);
+            return AccTestRunner<>(static_cast<int> (arguments.size()), &argv[0], output, output).Run(suite);
+        }
+
+        std::unique_ptr<AccTestSuiteLibrary> m_Library;
+        AccTestSuiteOptions m_DefaultOptions;
     };
 
+#endif // ACC_TEST_POSIX
+
 } // namespace ProTest
 
 // Use this macro to insert the default main() function for the test program. You can clone the code from here and write your 
@@ -550,9 +6279,46 @@ int main (int argc, char** argv)  \
     return ProTest::AccTestRunner<TEST_SUITE_NAME>(argc, argv).Run();    \
 }
 
+// Use this macro instead of ACC_TEST_DEFAULT_MAIN_FUNC in a test suite built as a shared library, e.g. with 
+// "g++ -std=c++11 -shared -fPIC -pthread", for AccTestSuiteHost to load (see AccTestSuiteLibrary).
+#ifdef __GNUC__
+#define ACC_TEST_EXPORTED __attribute__((visibility("default")))
+#else
+#define ACC_TEST_EXPORTED
+#endif
+#define ACC_TEST_EXPORT_SUITE(TEST_SUITE_NAME)  \
+extern "C" ACC_TEST_EXPORTED ProTest::AccTestSuite* ProTestCreateSuite()  \
+{   \
+    return new TEST_SUITE_NAME();    \
+}   \
+extern "C" ACC_TEST_EXPORTED void ProTestDestroySuite(ProTest::AccTestSuite* suite)  \
+{   \
+    delete static_cast<TEST_SUITE_NAME*> (suite);    \
+}
+
 #endif // __ACC_TEST_H__
 
 // Use this macro in your implementation of Verify() within the test steps to check for equality of two values with suitable 
-// failure output.
+// failure output. Each value is evaluated once and only formatted if they are not equal.
 #define ACC_TEST_CHECK_EQUAL(LEFT, RIGHT) \
-Check((LEFT) == (RIGHT)) << "NOT EQUAL: "#LEFT" = " << (LEFT) << ", "#RIGHT" = " << (RIGHT)
+this->CheckEqual((LEFT), (RIGHT), #LEFT, #RIGHT, ProTest::AccTestCheckSite {__FILE__, __LINE__, #LEFT " == " #RIGHT})
+
+// Use this macro to check any expression, e.g. ACC_TEST_CHECK(result.size() <= limit). If the expression is a comparison, the 
+// failure output shows the values on both sides of it. Each operand is evaluated once and only formatted if the check fails.
+// The comparison inside the expression binds tighter than the <= capturing its left operand, which GCC warns about. The 
+// warning is suppressed for the check alone; the loop runs once and lets the check be followed by << like the other checks.
+// This makes the check a statement rather than an expression: it can't be used as a value, e.g. in a condition.
+// Expressions joined by && or || have to be put in parentheses, as in ACC_TEST_CHECK((a < b && b < c)); they are then 
+// checked as a whole and the failure output shows only their value. Without the parentheses the check doesn't compile.
+#if defined(__GNUC__)
+#define ACC_TEST_SUPPRESS_PARENTHESES_WARNING _Pragma("GCC diagnostic push") _Pragma("GCC diagnostic ignored \"-Wparentheses\"")
+#define ACC_TEST_RESTORE_WARNINGS _Pragma("GCC diagnostic pop")
+#else
+#define ACC_TEST_SUPPRESS_PARENTHESES_WARNING
+#define ACC_TEST_RESTORE_WARNINGS
+#endif
+#define ACC_TEST_CHECK(EXPRESSION) \
+ACC_TEST_SUPPRESS_PARENTHESES_WARNING \
+for (std::ostream* accTestCheckOutput = &this->CheckExpression(ProTest::AccTestExpressionDecomposer() <= EXPRESSION, \
+        ProTest::AccTestCheckSite {__FILE__, __LINE__, #EXPRESSION}); accTestCheckOutput; accTestCheckOutput = nullptr) \
+ACC_TEST_RESTORE_WARNINGS *accTestCheckOutput << ""
@@ -0,0 +1,178 @@
+//    MIT License
+//
+//    Copyright (c) 2017 Muhammad Ismail Soboute
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy
+//    of this software and associated documentation files (the "Software"), to deal
+//    in the Software without restriction, including without limitation the rights
+//    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//    copies of the Software, and to permit persons to whom the Software is
+//    furnished to do so, subject to the following conditions:
+//
+//    The above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//    SOFTWARE.
+
+// Turns a binary log written by a test program run with --binary-log back into the report AccTestObserver prints. Build it
+// on its own, e.g. "g++ -std=c++11 -pthread AccTestLogDecoder.cpp -o AccTestLogDecoder", and run it as
+//   AccTestLogDecoder LOG                   print the whole report
+//   AccTestLogDecoder LOG --list            list the scenarios with their outcome and duration
+//   AccTestLogDecoder LOG --scenario=NAME   print the report of the scenarios named NAME only
+// Listing and picking scenarios use the index at the end of the log and don't read the rest of it; they need a log of a run
+// that finished. Where ACC_TEST_POSIX is defined the log is memory mapped rather than read.
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "AccTest.h"
+
+#ifdef ACC_TEST_POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+using namespace ProTest;
+
+// The contents of the log file, memory mapped where possible.
+
+class LogFile {
+public:
+
+    LogFile(const std::string& path) {
+#ifdef ACC_TEST_POSIX
+        auto fd = open(path.c_str(), O_RDONLY);
+        struct stat status;
+        if (fd >= 0 && fstat(fd, &status) == 0 && status.st_size > 0) {
+            auto mapping = mmap(nullptr, static_cast<std::size_t> (status.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping != MAP_FAILED) {
+                m_Mapping = mapping;
+                m_Data = static_cast<const char*> (mapping);
+                m_Size = static_cast<std::size_t> (status.st_size);
+            }
+        }
+        if (fd >= 0)
+            close(fd);
+        if (m_Mapping)
+            return;
+#endif
+        std::ifstream input(path.c_str(), std::ios::binary);
+        std::ostringstream contents;
+        contents << input.rdbuf();
+        m_Contents = contents.str();
+        m_Data = m_Contents.data();
+        m_Size = m_Contents.size();
+    }
+
+    ~LogFile() {
+#ifdef ACC_TEST_POSIX
+        if (m_Mapping)
+            munmap(m_Mapping, m_Size);
+#endif
+    }
+
+    const char* GetData() {
+        return m_Data;
+    }
+
+    std::size_t GetSize() {
+        return m_Size;
+    }
+
+private:
+    void* m_Mapping = nullptr;
+    std::string m_Contents;
+    const char* m_Data = nullptr;
+    std::size_t m_Size = 0;
+};
+
+const char* GetStatusName(unsigned long long status) {
+    switch (status) {
+        case AccTestBinaryLog::Passed: return "passed";
+        case AccTestBinaryLog::Failed: return "failed";
+        default: return "terminated";
+    }
+}
+
+int ListScenarios(AccTestBinaryLogReader& reader) {
+    for (std::size_t index = 0; index < reader.GetNumberOfScenarios(); ++index) {
+        auto scenario = reader.GetScenario(index);
+        std::cout << std::left << std::setw(12) << GetStatusName(scenario.Status) << std::right << std::fixed <<
+                std::setprecision(3) << std::setw(12) << (scenario.EndTime - scenario.StartTime) / 1e6 << " ms  " <<
+                reader.GetString(scenario.NameId) << '\n';
+    }
+    return 0;
+}
+
+int PrintScenarios(AccTestBinaryLogReader& reader, const std::string& name) {
+    std::vector<std::size_t> matching;
+    for (std::size_t index = 0; index < reader.GetNumberOfScenarios(); ++index)
+        if (reader.GetString(reader.GetScenario(index).NameId) == name)
+            matching.push_back(index);
+    if (matching.empty()) {
+        std::cerr << "The log has no scenario named " << name << std::endl;
+        return 1;
+    }
+    AccTestObserver observer(std::cout);
+    observer.StartingTestSuite(matching.size());
+    for (auto index : matching)
+        if (!reader.ReplayScenario(index, observer)) {
+            std::cerr << "The log is damaged." << std::endl;
+            return 1;
+        }
+    observer.FinishedTestSuite();
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    std::string path, scenario;
+    bool list = false;
+    for (int index = 1; index < argc; ++index) {
+        std::string argument = argv[index];
+        if (argument == "--list")
+            list = true;
+        else if (argument.compare(0, 11, "--scenario=") == 0)
+            scenario = argument.substr(11);
+        else if (path.empty() && argument.compare(0, 2, "--") != 0)
+            path = argument;
+        else {
+            std::cerr << "Unknown command line argument: " << argument << std::endl;
+            return -1;
+        }
+    }
+    if (path.empty()) {
+        std::cerr << "Usage: " << argv[0] << " LOG [--list | --scenario=NAME]" << std::endl;
+        return -1;
+    }
+    LogFile file(path);
+    AccTestBinaryLogReader reader(file.GetData(), file.GetSize());
+    if (!reader.IsValid()) {
+        std::cerr << path << " is not a ProTest binary log." << std::endl;
+        return 1;
+    }
+    if ((list || !scenario.empty()) && !reader.HasIndex()) {
+        std::cerr << path << " has no index; the run that wrote it didn't finish." << std::endl;
+        return 1;
+    }
+    if (list)
+        return ListScenarios(reader);
+    if (!scenario.empty())
+        return PrintScenarios(reader, scenario);
+    AccTestObserver observer(std::cout);
+    if (!reader.Replay(observer)) {
+        std::cout.flush();
+        std::cerr << "The log ends in the middle of an event; the run that wrote it didn't finish." << std::endl;
+        return 1;
+    }
+    return 0;
+}
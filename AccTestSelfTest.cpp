@@ -0,0 +1,1385 @@
+//    MIT License
+//
+//    Copyright (c) 2017 Muhammad Ismail Soboute
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy
+//    of this software and associated documentation files (the "Software"), to deal
+//    in the Software without restriction, including without limitation the rights
+//    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//    copies of the Software, and to permit persons to whom the Software is
+//    furnished to do so, subject to the following conditions:
+//
+//    The above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//    SOFTWARE.
+
+// Tests ProTest itself: the command line, name filters, the report, the binary log, the asynchronous observer, the worker 
+// pool, branches, shared fixtures, the context pool, process isolation, checkpoints, the result cache, and the statistics
+// of benchmarks and baselines. The tests are themselves single step scenarios of a suite run by AccTestRunner, so the 
+// program takes the usual options and its exit code is the number of failed tests. Build it on its own, e.g.
+// "g++ -std=c++11 -pthread AccTestSelfTest.cpp -o AccTestSelfTest", and run it after changing AccTest.h.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AccTest.h"
+
+#ifdef ACC_TEST_POSIX
+#include <dirent.h>
+#endif
+
+using namespace ProTest;
+
+struct SelfTestContext {
+};
+
+typedef AccTestStep<SelfTestContext> SelfTestStep;
+
+template <class StepType>
+class SelfTestScenario : public AccTestScenario<SelfTestContext> {
+public:
+
+    SelfTestScenario(const std::string& name)
+    : AccTestScenario<SelfTestContext>(name, "") {
+        CreateStep<StepType>();
+    }
+};
+
+// Parses the arguments as if they followed the name of the program.
+class CommandLine {
+public:
+
+    CommandLine(std::vector<std::string> arguments) {
+        arguments.insert(arguments.begin(), "AccTestSelfTest");
+        std::vector<char*> argv;
+        for (auto& argument : arguments)
+            argv.push_back(&argument[0]);
+        m_CommandLine.reset(new AccTestCommandLine(static_cast<int> (argv.size()), &argv[0]));
+    }
+
+    // The value of the option, or "(none)" if it wasn't given.
+    std::string Take(const std::string& name) {
+        std::string value = "(none)";
+        m_CommandLine->Take(name, value);
+        return value;
+    }
+
+    std::vector<std::string> GetUnknownArguments() {
+        return m_CommandLine->GetUnknownArguments();
+    }
+
+    AccTestCommandLine& Get() {
+        return *m_CommandLine;
+    }
+
+private:
+    std::unique_ptr<AccTestCommandLine> m_CommandLine;
+};
+
+#ifdef ACC_TEST_POSIX
+
+// A directory of its own under /tmp, removed along with the files in it when the test is done.
+class TemporaryDirectory {
+public:
+
+    TemporaryDirectory() {
+        char path[] = "/tmp/AccTestSelfTest.XXXXXX";
+        if (mkdtemp(path))
+            m_Path = path;
+    }
+
+    ~TemporaryDirectory() {
+        if (m_Path.empty())
+            return;
+        if (auto directory = opendir(m_Path.c_str())) {
+            while (auto entry = readdir(directory)) {
+                std::string name = entry->d_name;
+                if (name != "." && name != "..")
+                    std::remove((m_Path + "/" + name).c_str());
+            }
+            closedir(directory);
+        }
+        rmdir(m_Path.c_str());
+    }
+
+    const std::string& GetPath() const {
+        return m_Path;
+    }
+
+private:
+    std::string m_Path;
+};
+
+#endif
+
+class LongOptions : public SelfTestStep {
+public:
+
+    LongOptions()
+    : SelfTestStep("Long options", "--name=value, --name value, and flags") {
+    }
+
+    void Verify() override {
+        CommandLine commandLine({"--jobs", "3", "--filter=-*Slow", "--isolate", "--shuffle", "-q", "--output=a=b"});
+        ACC_TEST_CHECK_EQUAL(commandLine.Take("jobs"), "3");
+        ACC_TEST_CHECK_EQUAL(commandLine.Take("filter"), "-*Slow");
+        ACC_TEST_CHECK_EQUAL(commandLine.Take("isolate"), "");
+        ACC_TEST_CHECK_EQUAL(commandLine.Take("shuffle"), "");
+        ACC_TEST_CHECK_EQUAL(commandLine.Take("verbosity"), "quiet");
+        ACC_TEST_CHECK_EQUAL(commandLine.Take("output"), "a=b");
+        ACC_TEST_CHECK_EQUAL(commandLine.Take("jobs"), "(none)");
+        ACC_TEST_CHECK(commandLine.GetUnknownArguments().empty());
+    }
+};
+
+class ShortOptions : public SelfTestStep {
+public:
+
+    ShortOptions()
+    : SelfTestStep("Short options", "Values attached, separate, implied, and optional") {
+    }
+
+    void Verify() override {
+        CommandLine attached({"-j4", "-r10", "-fLogin*", "-s42", "-o", "report.txt"});
+        ACC_TEST_CHECK_EQUAL(attached.Take("jobs"), "4");
+        ACC_TEST_CHECK_EQUAL(attached.Take("repeat"), "10");
+        ACC_TEST_CHECK_EQUAL(attached.Take("filter"), "Login*");
+        ACC_TEST_CHECK_EQUAL(attached.Take("shuffle"), "42");
+        ACC_TEST_CHECK_EQUAL(attached.Take("output"), "report.txt");
+        CommandLine separate({"-j", "2", "-f", "-*Slow", "-s", "7", "-i", "-h"});
+        ACC_TEST_CHECK_EQUAL(separate.Take("jobs"), "2");
+        ACC_TEST_CHECK_EQUAL(separate.Take("filter"), "-*Slow");
+        ACC_TEST_CHECK_EQUAL(separate.Take("shuffle"), "7");
+        ACC_TEST_CHECK_EQUAL(separate.Take("isolate"), "");
+        ACC_TEST_CHECK_EQUAL(separate.Take("help"), "");
+        CommandLine seedless({"-s", "-q", "-j", "2"});
+        ACC_TEST_CHECK_EQUAL(seedless.Take("shuffle"), "");
+        ACC_TEST_CHECK_EQUAL(seedless.Take("verbosity"), "quiet");
+        ACC_TEST_CHECK_EQUAL(seedless.Take("jobs"), "2");
+        CommandLine last({"-s"});
+        ACC_TEST_CHECK_EQUAL(last.Take("shuffle"), "");
+    }
+};
+
+class UnknownAndInvalidArguments : public SelfTestStep {
+public:
+
+    UnknownAndInvalidArguments()
+    : SelfTestStep("Unknown and invalid arguments", "Reported rather than ignored") {
+    }
+
+    void Verify() override {
+        CommandLine unknown({"-x", "stray", "-qx", "--bogus"});
+        auto unknownArguments = unknown.GetUnknownArguments();
+        std::sort(unknownArguments.begin(), unknownArguments.end());
+        ACC_TEST_CHECK_EQUAL(unknownArguments, std::vector<std::string>({"--bogus", "-qx", "-x", "stray"}));
+        CommandLine invalid({"--jobs=abc", "--repeat=-1"});
+        std::size_t size = 0;
+        ACC_TEST_CHECK(Throws([&invalid, &size] { invalid.Get().TakeSize("jobs", size); }));
+        ACC_TEST_CHECK(Throws([&invalid, &size] { invalid.Get().TakeSize("repeat", size); }));
+    }
+
+private:
+
+    template <class Function>
+    static bool Throws(Function function) {
+        try {
+            function();
+        } catch (const std::invalid_argument&) {
+            return true;
+        }
+        return false;
+    }
+};
+
+class GlobFilters : public SelfTestStep {
+public:
+
+    GlobFilters()
+    : SelfTestStep("Glob filters", "Positive and negative patterns with * and ?") {
+    }
+
+    void Verify() override {
+        ACC_TEST_CHECK(AccTestNameFilter().IsEmpty());
+        ACC_TEST_CHECK(AccTestNameFilter().MatchesAny({}));
+        AccTestNameFilter login("Login*");
+        ACC_TEST_CHECK(login.Matches("LoginOk"));
+        ACC_TEST_CHECK(!login.Matches("Logout"));
+        ACC_TEST_CHECK(!login.Matches("MyLogin"));
+        AccTestNameFilter notSlow("Login*-*Slow");
+        ACC_TEST_CHECK(notSlow.Matches("LoginFast"));
+        ACC_TEST_CHECK(!notSlow.Matches("LoginSlow"));
+        AccTestNameFilter negativeOnly("-*Slow:*Flaky");
+        ACC_TEST_CHECK(negativeOnly.Matches("Anything"));
+        ACC_TEST_CHECK(!negativeOnly.Matches("VerySlow"));
+        ACC_TEST_CHECK(!negativeOnly.Matches("SomewhatFlaky"));
+        AccTestNameFilter alternatives("A?C:X*");
+        ACC_TEST_CHECK(alternatives.Matches("ABC"));
+        ACC_TEST_CHECK(alternatives.Matches("Xyz"));
+        ACC_TEST_CHECK(!alternatives.Matches("AC"));
+        ACC_TEST_CHECK(alternatives.MatchesAny({"none", "Xylophone"}));
+        ACC_TEST_CHECK(!alternatives.MatchesAny({"none"}));
+    }
+};
+
+class RegexFilters : public SelfTestStep {
+public:
+
+    RegexFilters()
+    : SelfTestStep("Regex filters", "Patterns in slashes match any part of the name") {
+    }
+
+    void Verify() override {
+        AccTestNameFilter numbered("/Input[0-9]+/");
+        ACC_TEST_CHECK(numbered.Matches("StepInput42Done"));
+        ACC_TEST_CHECK(!numbered.Matches("Input"));
+        AccTestNameFilter withSeparators("/a-b:c/-/skip/");
+        ACC_TEST_CHECK(withSeparators.Matches("xa-b:cx"));
+        ACC_TEST_CHECK(!withSeparators.Matches("a-b:c skip"));
+    }
+};
+
+// Two scenarios, one passing and one failing, to be logged.
+struct LoggedContext {
+};
+
+class LoggedStep : public AccTestStep<LoggedContext> {
+public:
+
+    LoggedStep(bool passes)
+    : AccTestStep<LoggedContext>("Logged step", "Checks something"), m_Passes(passes) {
+    }
+
+    void Verify() override {
+        int answer = 42;
+        ACC_TEST_CHECK(answer == (m_Passes ? 42 : 41)) << "as logged";
+    }
+
+private:
+    bool m_Passes;
+};
+
+class LoggedScenario : public AccTestScenario<LoggedContext> {
+public:
+
+    LoggedScenario(const std::string& name, bool passes)
+    : AccTestScenario<LoggedContext>(name, "A logged scenario") {
+        CreateStep<LoggedStep>(true);
+        CreateStep<LoggedStep>(passes);
+    }
+};
+
+class LoggedSuite : public AccTestSuite {
+public:
+
+    LoggedSuite() {
+        CreateScenario<LoggedScenario>("Passing", true);
+        CreateScenario<LoggedScenario>("Failing", false);
+    }
+};
+
+// Every second scenario fails.
+class ManyScenarios : public AccTestSuite {
+public:
+
+    ManyScenarios(std::size_t numberOfScenarios) {
+        for (std::size_t scenario = 0; scenario < numberOfScenarios; ++scenario)
+            CreateScenario<LoggedScenario>("Scenario " + std::to_string(scenario), scenario % 2 == 0);
+    }
+};
+
+class BinaryLogRoundTrip : public SelfTestStep {
+public:
+
+    BinaryLogRoundTrip()
+    : SelfTestStep("Binary log round trip", "Replaying a binary log gives the report of the run that wrote it") {
+    }
+
+    void Verify() override {
+        std::ostringstream report, log;
+        auto observers = std::make_shared<AccTestObserverGroup>();
+        observers->Add(std::make_shared<AccTestObserver>(report));
+        observers->Add(std::make_shared<AccTestBinaryLogObserver>(log));
+        LoggedSuite suite;
+        suite.SetTestObserver(observers);
+        suite.Run();
+        auto data = log.str();
+        AccTestBinaryLogReader reader(data.data(), data.size());
+        ACC_TEST_CHECK(reader.IsValid());
+        ACC_TEST_CHECK(reader.HasIndex());
+        ACC_TEST_CHECK_EQUAL(reader.GetNumberOfScenarios(), 2u);
+        if (reader.GetNumberOfScenarios() == 2) {
+            ACC_TEST_CHECK_EQUAL(reader.GetString(reader.GetScenario(0).NameId), "Passing");
+            ACC_TEST_CHECK_EQUAL(reader.GetScenario(0).Status, static_cast<unsigned long long> (AccTestBinaryLog::Passed));
+            ACC_TEST_CHECK_EQUAL(reader.GetString(reader.GetScenario(1).NameId), "Failing");
+            ACC_TEST_CHECK_EQUAL(reader.GetScenario(1).Status, static_cast<unsigned long long> (AccTestBinaryLog::Failed));
+        }
+        std::ostringstream replayedReport;
+        AccTestObserver replayed(replayedReport);
+        ACC_TEST_CHECK(reader.Replay(replayed));
+        ACC_TEST_CHECK(replayedReport.str() == report.str()) << "The replayed report differs:\n" << replayedReport.str();
+        AccTestBinaryLogReader truncated(data.data(), data.size() / 2);
+        std::ostringstream truncatedReport;
+        AccTestObserver truncatedObserver(truncatedReport);
+        ACC_TEST_CHECK(!truncated.HasIndex());
+        ACC_TEST_CHECK(!truncated.Replay(truncatedObserver));
+    }
+};
+
+class StepTimingOutput : public SelfTestStep {
+public:
+
+    StepTimingOutput()
+    : SelfTestStep("Step timing output", "Step durations are only written when asked for; scenario totals always are") {
+    }
+
+    void Verify() override {
+        auto normal = Report(false), detailed = Report(true);
+        ACC_TEST_CHECK(normal.find("Step duration:") == std::string::npos);
+        ACC_TEST_CHECK(normal.find("Running scenario step tear-down...\n\n      Starting") != std::string::npos);
+        ACC_TEST_CHECK(normal.find("Scenario duration:") != std::string::npos);
+        ACC_TEST_CHECK(detailed.find("Running scenario step tear-down...\n        Step duration:") != std::string::npos);
+    }
+
+private:
+
+    static std::string Report(bool stepTimingOutput) {
+        std::ostringstream report;
+        auto observer = std::make_shared<AccTestObserver>(report);
+        observer->SetStepTimingOutput(stepTimingOutput);
+        LoggedSuite suite;
+        suite.SetTestObserver(observer);
+        suite.Run();
+        return report.str();
+    }
+};
+
+class QueueOrdering : public SelfTestStep {
+public:
+
+    QueueOrdering()
+    : SelfTestStep("Queue ordering", "Records pushed by several threads are popped once each, in order per thread") {
+    }
+
+    void Verify() override {
+        const std::size_t numberOfThreads = 4, numberOfRecords = 10000;
+        AccTestEventQueue queue(16);
+        std::vector<std::thread> producers;
+        for (std::size_t producer = 0; producer < numberOfThreads; ++producer) {
+            producers.emplace_back([&queue, producer, numberOfRecords]() {
+                AccTestEventRecord record;
+                record.NameId = producer;
+                for (record.Count = 0; record.Count < numberOfRecords; ++record.Count) {
+                    while (!queue.TryPush(record))
+                        std::this_thread::yield();
+                }
+            });
+        }
+        std::vector<std::size_t> nextCount(numberOfThreads);
+        bool inOrder = true;
+        AccTestEventRecord record;
+        for (std::size_t popped = 0; popped < numberOfThreads * numberOfRecords;) {
+            if (!queue.TryPop(record)) {
+                std::this_thread::yield();
+                continue;
+            }
+            inOrder = inOrder && record.NameId < numberOfThreads && record.Count == nextCount[record.NameId]++;
+            ++popped;
+        }
+        for (auto& producer : producers)
+            producer.join();
+        ACC_TEST_CHECK(inOrder);
+        ACC_TEST_CHECK(queue.IsEmpty());
+        ACC_TEST_CHECK(!queue.TryPop(record));
+    }
+};
+
+class AsyncObserverBlocking : public SelfTestStep {
+public:
+
+    AsyncObserverBlocking()
+    : SelfTestStep("Async observer blocking", "With Block, every event of every thread arrives, in order per thread") {
+    }
+
+    void Verify() override {
+        const int numberOfThreads = 4, numberOfEvents = 5000;
+        auto recorder = std::make_shared<AccTestEventRecorder>();
+        {
+            AccTestAsyncObserver observer(recorder, 8, AccTestBackpressurePolicy::Block, 64);
+            std::vector<std::thread> producers;
+            for (int producer = 0; producer < numberOfThreads; ++producer) {
+                producers.emplace_back([&observer, producer, numberOfEvents]() {
+                    for (int event = 0; event < numberOfEvents; ++event) {
+                        if (event % 2 == 0)
+                            observer.ScenarioBranched(static_cast<std::size_t> (producer * numberOfEvents + event));
+                        else
+                            observer.ScenarioCrashed(std::to_string(producer * numberOfEvents + event));
+                    }
+                });
+            }
+            for (auto& producer : producers)
+                producer.join();
+            observer.Flush();
+        }
+        const auto& events = recorder->GetEvents();
+        ACC_TEST_CHECK_EQUAL(events.size(), static_cast<std::size_t> (numberOfThreads * numberOfEvents));
+        std::vector<int> nextEvent(numberOfThreads);
+        bool inOrder = true;
+        for (const auto& event : events) {
+            auto number = event.Type == AccTestEventType::ScenarioBranched ? static_cast<int> (event.Count) : 
+                    std::stoi(event.Description);
+            auto producer = number / numberOfEvents;
+            inOrder = inOrder && number % numberOfEvents == nextEvent[producer]++ &&
+                    (event.Type == AccTestEventType::ScenarioBranched) == (number % 2 == 0);
+        }
+        ACC_TEST_CHECK(inOrder);
+    }
+};
+
+// Slows the writer thread of an AccTestAsyncObserver down so that its queue fills up.
+class SlowObserver : public AccTestEventRecorder {
+protected:
+
+    void Record(const AccTestEvent& /*event*/) override {
+        std::this_thread::sleep_for(std::chrono::microseconds(20));
+    }
+};
+
+class AsyncObserverDropping : public SelfTestStep {
+public:
+
+    AsyncObserverDropping()
+    : SelfTestStep("Async observer dropping", "With DropEvents, whole scenarios are left out and the totals add up") {
+    }
+
+    void Verify() override {
+        std::ostringstream report;
+        auto textObserver = std::make_shared<AccTestObserver>(report);
+        auto observers = std::make_shared<AccTestObserverGroup>();
+        observers->Add(textObserver);
+        observers->Add(std::make_shared<SlowObserver>());
+        auto observer = std::make_shared<AccTestAsyncObserver>(observers, 4, AccTestBackpressurePolicy::DropEvents);
+        const std::size_t numberOfScenarios = 300;
+        ManyScenarios suite(numberOfScenarios);
+        suite.SetTestObserver(observer);
+        suite.Run();
+        auto summary = textObserver->GetSummary();
+        auto text = report.str();
+        ACC_TEST_CHECK_EQUAL(summary.NumberOfScenarios, numberOfScenarios);
+        ACC_TEST_CHECK(summary.NumberOfScenariosDropped > 0u);
+        ACC_TEST_CHECK_EQUAL(summary.NumberOfScenariosDropped, observer->GetNumberOfDroppedScenarios());
+        ACC_TEST_CHECK_EQUAL(summary.GetNumberOfScenariosPassed() + summary.NumberOfScenariosFailed + 
+                summary.NumberOfScenariosTerminated + summary.NumberOfScenariosDropped, summary.NumberOfScenarios);
+        auto reported = summary.NumberOfScenarios - summary.NumberOfScenariosDropped;
+        ACC_TEST_CHECK_EQUAL(Count(text, "Starting execution of test scenario"), reported);
+        ACC_TEST_CHECK_EQUAL(Count(text, "Finished execution of test scenario"), reported);
+        ACC_TEST_CHECK_EQUAL(Count(text, "Starting execution of scenario step"), 2 * reported);
+        ACC_TEST_CHECK_EQUAL(Count(text, "Number of failed steps: 1 out of 2"), summary.NumberOfScenariosFailed);
+        ACC_TEST_CHECK(text.find("left out of the report") != std::string::npos);
+    }
+
+private:
+
+    static std::size_t Count(const std::string& text, const std::string& pattern) {
+        std::size_t count = 0;
+        for (auto position = text.find(pattern); position != std::string::npos; position = text.find(pattern, position + 1))
+            ++count;
+        return count;
+    }
+};
+
+class WorkerPoolTasks : public SelfTestStep {
+public:
+
+    WorkerPoolTasks()
+    : SelfTestStep("Worker pool tasks", "Every task runs once, and idle workers steal the tasks of a busy one") {
+    }
+
+    void Verify() override {
+        const std::size_t numberOfTasks = 1000;
+        std::vector<std::atomic<int> > runs(numberOfTasks);
+        std::vector<std::size_t> workerOfTask(numberOfTasks);
+        std::atomic<std::size_t> tasksFinished {0};
+        std::atomic<bool> blocked {false};
+        bool othersFinishedFirst = false;
+        std::size_t blockedWorker = 0;
+        AccTestWorkerPool pool(4);
+        pool.Run(numberOfTasks, [&](std::size_t task, std::size_t worker) {
+            // The first task to start keeps its worker busy until the others have run every other task, including those
+            // dealt to the busy worker.
+            if (!blocked.exchange(true)) {
+                auto deadline = AccTestClock::now() + std::chrono::seconds(10);
+                while (tasksFinished.load() < numberOfTasks - 1 && AccTestClock::now() < deadline)
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                othersFinishedFirst = tasksFinished.load() == numberOfTasks - 1;
+                blockedWorker = worker;
+            }
+            ++runs[task];
+            workerOfTask[task] = worker;
+            ++tasksFinished;
+        });
+        ACC_TEST_CHECK(std::all_of(runs.begin(), runs.end(), [](const std::atomic<int>& count) { return count == 1; }));
+        ACC_TEST_CHECK(othersFinishedFirst);
+        ACC_TEST_CHECK_EQUAL(std::count(workerOfTask.begin(), workerOfTask.end(), blockedWorker), 1);
+        ACC_TEST_CHECK_EQUAL(AccTestWorkerPool(0).GetNumberOfWorkers(), 1u);
+    }
+};
+
+class ParallelSuite : public SelfTestStep {
+public:
+
+    ParallelSuite()
+    : SelfTestStep("Parallel suite", "Scenarios run by several jobs are each reported once, as a whole") {
+    }
+
+    void Verify() override {
+        std::ostringstream report;
+        auto textObserver = std::make_shared<AccTestObserver>(report);
+        auto verdicts = std::make_shared<AccTestVerdictObserver>();
+        auto observers = std::make_shared<AccTestObserverGroup>();
+        observers->Add(textObserver);
+        observers->Add(verdicts);
+        ManyScenarios suite(40);
+        AccTestSuiteOptions options;
+        options.NumberOfJobs = 4;
+        suite.SetOptions(options);
+        suite.SetTestObserver(observers);
+        suite.Run();
+        auto summary = textObserver->GetSummary();
+        ACC_TEST_CHECK_EQUAL(summary.NumberOfScenarios, 40u);
+        ACC_TEST_CHECK_EQUAL(summary.NumberOfScenariosFailed, 20u);
+        ACC_TEST_CHECK_EQUAL(verdicts->GetScenarioVerdicts().size(), 40u);
+        bool verdictsMatch = true;
+        for (const auto& verdict : verdicts->GetScenarioVerdicts())
+            verdictsMatch = verdictsMatch && verdict.second == (std::stoi(verdict.first.substr(9)) % 2 == 0);
+        ACC_TEST_CHECK(verdictsMatch);
+        // Each scenario is reported with its own two steps and nothing of another scenario in between.
+        bool reportedWhole = true;
+        int stepsInScenario = -1;
+        std::istringstream lines(report.str());
+        for (std::string line; std::getline(lines, line);) {
+            if (line.find("Starting execution of test scenario") != std::string::npos) {
+                reportedWhole = reportedWhole && stepsInScenario < 0;
+                stepsInScenario = 0;
+            } else if (line.find("Starting execution of scenario step") != std::string::npos)
+                ++stepsInScenario;
+            else if (line.find("Finished execution of test scenario") != std::string::npos) {
+                reportedWhole = reportedWhole && stepsInScenario == 2;
+                stepsInScenario = -1;
+            }
+        }
+        ACC_TEST_CHECK(reportedWhole);
+    }
+};
+
+class BenchmarkStatistics : public SelfTestStep {
+public:
+
+    BenchmarkStatistics()
+    : SelfTestStep("Benchmark statistics", "Nearest-rank percentiles, mean, and standard deviation") {
+    }
+
+    void Verify() override {
+        std::vector<AccTestClock::duration> samples;
+        for (int sample = 100; sample > 0; --sample)
+            samples.push_back(AccTestClock::duration(sample));
+        auto result = AccTestBenchmarkResult::FromSamples(samples, 5);
+        ACC_TEST_CHECK_EQUAL(result.WarmupIterations, 5u);
+        ACC_TEST_CHECK_EQUAL(result.Iterations, 100u);
+        ACC_TEST_CHECK_EQUAL(result.Min.count(), 1);
+        ACC_TEST_CHECK_EQUAL(result.Median.count(), 50);
+        ACC_TEST_CHECK_EQUAL(result.P90.count(), 90);
+        ACC_TEST_CHECK_EQUAL(result.P99.count(), 99);
+        ACC_TEST_CHECK_EQUAL(result.Max.count(), 100);
+        ACC_TEST_CHECK_EQUAL(result.Mean.count(), 51);
+        ACC_TEST_CHECK_EQUAL(result.StdDev.count(), 29);
+        auto single = AccTestBenchmarkResult::FromSamples({AccTestClock::duration(7)}, 0);
+        ACC_TEST_CHECK_EQUAL(single.Median.count(), 7);
+        ACC_TEST_CHECK_EQUAL(single.P99.count(), 7);
+        ACC_TEST_CHECK_EQUAL(single.StdDev.count(), 0);
+        auto none = AccTestBenchmarkResult::FromSamples({}, 0);
+        ACC_TEST_CHECK_EQUAL(none.Iterations, 0u);
+        ACC_TEST_CHECK_EQUAL(none.Max.count(), 0);
+    }
+};
+
+class BaselineComparison : public SelfTestStep {
+public:
+
+    BaselineComparison()
+    : SelfTestStep("Baseline comparison", "Only significantly and substantially slower timings regress") {
+    }
+
+    void Verify() override {
+        std::vector<AccTestClock::duration> baseline, same, slower, slightlySlower;
+        for (int sample = 0; sample < 30; ++sample) {
+            baseline.push_back(AccTestClock::duration(1000 + sample));
+            same.push_back(AccTestClock::duration(1000 + (sample * 7) % 30));
+            slower.push_back(AccTestClock::duration(2000 + sample));
+            slightlySlower.push_back(AccTestClock::duration(1031 + sample));
+        }
+        AccTestBaselineOptions options;
+        auto unchanged = AccTestBaselineComparison::Compare(same, baseline, options);
+        ACC_TEST_CHECK(!unchanged.Regressed);
+        ACC_TEST_CHECK(unchanged.PValue > 0.4);
+        auto regressed = AccTestBaselineComparison::Compare(slower, baseline, options);
+        ACC_TEST_CHECK(regressed.Regressed);
+        ACC_TEST_CHECK(regressed.PValue < 1e-6);
+        ACC_TEST_CHECK_EQUAL(regressed.BaselineMedian.count(), 1014);
+        auto belowThreshold = AccTestBaselineComparison::Compare(slightlySlower, baseline, options);
+        ACC_TEST_CHECK(belowThreshold.PValue < options.Significance);
+        ACC_TEST_CHECK(!belowThreshold.Regressed);
+        ACC_TEST_CHECK(!AccTestBaselineComparison::Compare({}, baseline, options).Regressed);
+    }
+};
+
+class RunnerOptions : public SelfTestStep {
+public:
+
+    RunnerOptions()
+    : SelfTestStep("Runner options", "AccTestRunner runs the suite with short options and rejects unknown ones") {
+    }
+
+    void Verify() override {
+        ACC_TEST_CHECK_EQUAL(Run({"-s", "-q", "-j", "2"}), 1);
+        ACC_TEST_CHECK_EQUAL(Run({"-s", "-q", "-fPass*"}), 0);
+        ACC_TEST_CHECK_EQUAL(Run({"-q", "--no-such-option"}), -1);
+    }
+
+private:
+
+    static int Run(std::vector<std::string> arguments) {
+        arguments.insert(arguments.begin(), "LoggedSuite");
+        std::vector<char*> argv;
+        for (auto& argument : arguments)
+            argv.push_back(&argument[0]);
+        std::ostringstream output;
+        return AccTestRunner<LoggedSuite>(static_cast<int> (argv.size()), &argv[0], output, output).Run();
+    }
+};
+
+// The tests forking processes run one at a time, even when the self-tests are run by several jobs: a child forked by one
+// would keep the pipes of the worker processes of the other open, so those would never see the end of their input.
+std::mutex forkingTestMutex;
+
+// A scenario counting how many times its common step runs, with two branches that each change the context in their own
+// way and check that the other one didn't. The branches of a ForkedBranchContext run in child processes.
+struct BranchContext {
+    int Value = 0;
+};
+
+struct ForkedBranchContext : BranchContext {
+};
+
+namespace ProTest {
+
+    template <>
+    struct AccTestContextTraits<ForkedBranchContext> {
+        static const bool IsCopyable = false;
+    };
+}
+
+template <class ContextType>
+class BranchStep : public AccTestStep<ContextType> {
+public:
+
+    BranchStep(int add, int multiply, int expected, int* runs)
+    : AccTestStep<ContextType>("Branch step", "Changes the value"), m_Add(add), m_Multiply(multiply), m_Expected(expected),
+    m_Runs(runs) {
+    }
+
+    void Act() override {
+        ++*m_Runs;
+        auto& value = this->GetTestContext()->Value;
+        value = (value + m_Add) * m_Multiply;
+    }
+
+    void Verify() override {
+        ACC_TEST_CHECK_EQUAL(this->GetTestContext()->Value, m_Expected);
+    }
+
+private:
+    int m_Add, m_Multiply, m_Expected;
+    int* m_Runs;
+};
+
+template <class ContextType>
+class BranchingScenario : public AccTestScenario<ContextType> {
+public:
+
+    BranchingScenario(int* commonRuns, int* branchRuns)
+    : AccTestScenario<ContextType>("Branching", "Shares its first step") {
+        this->template CreateStep< BranchStep<ContextType> >(1, 1, 1, commonRuns);
+        this->BeginBranch("Double", "Doubles the value");
+        this->template CreateStep< BranchStep<ContextType> >(0, 2, 2, branchRuns);
+        this->BeginBranch("Add ten", "Adds ten to the value");
+        this->template CreateStep< BranchStep<ContextType> >(10, 1, 11, branchRuns);
+    }
+};
+
+// Checkpoints can't be taken in a scenario with branches.
+class BranchingCheckpointScenario : public AccTestScenario<BranchContext> {
+public:
+
+    BranchingCheckpointScenario()
+    : AccTestScenario<BranchContext>("Branching with checkpoints", "Fails to construct") {
+        int runs = 0;
+        CreateStep< BranchStep<BranchContext> >(1, 1, 1, &runs);
+        CreateCheckpoint();
+        BeginBranch("Branch", "Never runs");
+    }
+};
+
+template <class ContextType>
+class BranchingSuite : public AccTestSuite {
+public:
+
+    BranchingSuite(int* commonRuns, int* branchRuns) {
+        CreateScenario< BranchingScenario<ContextType> >(commonRuns, branchRuns);
+    }
+};
+
+class BranchingCheckpointSuite : public AccTestSuite {
+public:
+
+    BranchingCheckpointSuite() {
+        CreateScenario<BranchingCheckpointScenario>();
+    }
+};
+
+class Branches : public SelfTestStep {
+public:
+
+    Branches()
+    : SelfTestStep("Branches", "Common steps run once and each branch continues from its own copy of the context") {
+    }
+
+    void Verify() override {
+        Check<BranchContext>(1);
+#ifdef ACC_TEST_POSIX
+        // The branches run in child processes, so their runs aren't counted here.
+        {
+            std::lock_guard<std::mutex> lock(forkingTestMutex);
+            Check<ForkedBranchContext>(0);
+        }
+#endif
+        std::ostringstream report;
+        auto textObserver = std::make_shared<AccTestObserver>(report);
+        BranchingCheckpointSuite suite;
+        suite.SetTestObserver(textObserver);
+        suite.Run();
+        ACC_TEST_CHECK_EQUAL(textObserver->GetSummary().NumberOfScenariosTerminated, 1u);
+        ACC_TEST_CHECK(report.str().find("has both branches and checkpoints") != std::string::npos) << report.str();
+    }
+
+private:
+
+    template <class ContextType>
+    void Check(int branchRunsPerBranch) {
+        std::ostringstream report;
+        auto textObserver = std::make_shared<AccTestObserver>(report);
+        auto verdicts = std::make_shared<AccTestVerdictObserver>();
+        auto observers = std::make_shared<AccTestObserverGroup>();
+        observers->Add(textObserver);
+        observers->Add(verdicts);
+        int commonRuns = 0, branchRuns = 0;
+        BranchingSuite<ContextType> suite(&commonRuns, &branchRuns);
+        suite.SetTestObserver(observers);
+        suite.Run();
+        ACC_TEST_CHECK_EQUAL(commonRuns, 1);
+        ACC_TEST_CHECK_EQUAL(branchRuns, 2 * branchRunsPerBranch);
+        auto summary = textObserver->GetSummary();
+        ACC_TEST_CHECK_EQUAL(summary.NumberOfScenarios, 2u);
+        ACC_TEST_CHECK_EQUAL(summary.GetNumberOfScenariosPassed(), 2u) << report.str();
+        std::map<std::string, bool> expectedVerdicts {{"Branching/Double", true}, {"Branching/Add ten", true}};
+        ACC_TEST_CHECK(verdicts->GetScenarioVerdicts() == expectedVerdicts);
+    }
+};
+
+// Scenarios writing to a log when they use a shared fixture, which logs when it is built and destroyed.
+class FixtureLog {
+public:
+
+    void Write(const std::string& entry) {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Entries.push_back(entry);
+    }
+
+    std::vector<std::string> GetEntries() {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_Entries;
+    }
+
+private:
+    std::mutex m_Mutex;
+    std::vector<std::string> m_Entries;
+};
+
+class LoggedFixture {
+public:
+
+    LoggedFixture(FixtureLog* log)
+    : m_Log(log) {
+        m_Log->Write("built");
+    }
+
+    ~LoggedFixture() {
+        m_Log->Write("destroyed");
+    }
+
+    FixtureLog& GetLog() {
+        return *m_Log;
+    }
+
+private:
+    FixtureLog* m_Log;
+};
+
+struct FixtureContext {
+    LoggedFixture* Fixture = nullptr;
+};
+
+class FixtureStep : public AccTestStep<FixtureContext> {
+public:
+
+    FixtureStep(bool usesFixture)
+    : AccTestStep<FixtureContext>("Fixture step", "Has the fixture if it asked for it"), m_UsesFixture(usesFixture) {
+    }
+
+    void Verify() override {
+        ACC_TEST_CHECK_EQUAL(GetTestContext()->Fixture != nullptr, m_UsesFixture);
+    }
+
+private:
+    bool m_UsesFixture;
+};
+
+class FixtureScenario : public AccTestScenario<FixtureContext> {
+public:
+
+    FixtureScenario(const std::string& name, FixtureLog* log, bool usesFixture)
+    : AccTestScenario<FixtureContext>(name, "Uses the fixture or not"), m_Log(log), m_UsesFixture(usesFixture) {
+        CreateStep<FixtureStep>(usesFixture);
+    }
+
+    void Setup() override {
+        GetTestContext()->Fixture = m_UsesFixture ? &GetFixture<LoggedFixture>("Logged") : nullptr;
+        m_Log->Write(GetName());
+    }
+
+private:
+    FixtureLog* m_Log;
+    bool m_UsesFixture;
+};
+
+class FixtureSuite : public AccTestSuite {
+public:
+
+    FixtureSuite(FixtureLog* log, AccTestFixtureScope scope, std::size_t numberOfUsers) {
+        CreateFixture<LoggedFixture>("Logged", scope, log);
+        AccTestScenarioInfo info;
+        info.Fixtures = {"Logged"};
+        for (std::size_t user = 0; user < numberOfUsers; ++user) {
+            info.Name = "User " + std::to_string(user);
+            CreateScenario<FixtureScenario>(info, info.Name, log, true);
+        }
+        CreateScenario<FixtureScenario>("Other", log, false);
+        // Asks for a fixture it didn't list.
+        CreateScenario<FixtureScenario>("Undeclared", log, true);
+    }
+};
+
+class SharedFixtures : public SelfTestStep {
+public:
+
+    SharedFixtures()
+    : SelfTestStep("Shared fixtures", "Built once by the first user and destroyed after the last one") {
+    }
+
+    void Verify() override {
+        FixtureLog serialLog;
+        auto summary = Run(serialLog, AccTestFixtureScope::Suite, 1);
+        ACC_TEST_CHECK_EQUAL(serialLog.GetEntries(), 
+                std::vector<std::string>({"built", "User 0", "User 1", "User 2", "destroyed", "Other"}));
+        ACC_TEST_CHECK_EQUAL(summary.GetNumberOfScenariosPassed(), 4u);
+        ACC_TEST_CHECK_EQUAL(summary.NumberOfScenariosTerminated, 1u);
+        FixtureLog suiteLog;
+        Run(suiteLog, AccTestFixtureScope::Suite, 3);
+        auto entries = suiteLog.GetEntries();
+        ACC_TEST_CHECK_EQUAL(std::count(entries.begin(), entries.end(), "built"), 1);
+        ACC_TEST_CHECK_EQUAL(std::count(entries.begin(), entries.end(), "destroyed"), 1);
+        ACC_TEST_CHECK(std::find(entries.begin(), entries.end(), "built") < 
+                std::find(entries.begin(), entries.end(), "destroyed"));
+        FixtureLog workerLog;
+        Run(workerLog, AccTestFixtureScope::Worker, 3);
+        entries = workerLog.GetEntries();
+        auto built = std::count(entries.begin(), entries.end(), "built");
+        ACC_TEST_CHECK((built >= 1 && built <= 3)) << built << " instances were built";
+        ACC_TEST_CHECK_EQUAL(std::count(entries.begin(), entries.end(), "destroyed"), built);
+    }
+
+private:
+
+    static AccTestSummary Run(FixtureLog& log, AccTestFixtureScope scope, std::size_t numberOfJobs) {
+        std::ostringstream report;
+        auto textObserver = std::make_shared<AccTestObserver>(report);
+        FixtureSuite suite(&log, scope, 3);
+        AccTestSuiteOptions options;
+        options.NumberOfJobs = numberOfJobs;
+        suite.SetOptions(options);
+        suite.SetTestObserver(textObserver);
+        suite.Run();
+        return textObserver->GetSummary();
+    }
+};
+
+// Contexts with a Reset() method, counting how often they are constructed and reset. Each step checks that it starts from
+// a new or reset context before changing it.
+std::atomic<int> pooledContextsConstructed {0}, pooledContextsReset {0};
+
+struct PooledContext {
+
+    PooledContext() {
+        ++pooledContextsConstructed;
+    }
+
+    void Reset() {
+        ++pooledContextsReset;
+        Value = 0;
+    }
+
+    int Value = 0;
+};
+
+struct UnresettableContext : PooledContext {
+
+    void Reset() {
+        throw std::runtime_error("Can't be reset");
+    }
+};
+
+template <class ContextType>
+class PooledStep : public AccTestStep<ContextType> {
+public:
+
+    PooledStep()
+    : AccTestStep<ContextType>("Pooled step", "Starts from a new or reset context") {
+    }
+
+    void Verify() override {
+        ACC_TEST_CHECK_EQUAL(this->GetTestContext()->Value, 0);
+        this->GetTestContext()->Value = 42;
+    }
+};
+
+template <class ContextType>
+class PooledScenario : public AccTestScenario<ContextType> {
+public:
+
+    PooledScenario(const std::string& name)
+    : AccTestScenario<ContextType>(name, "Uses a pooled context") {
+        this->template CreateStep< PooledStep<ContextType> >();
+    }
+};
+
+template <class ContextType>
+class PooledSuite : public AccTestSuite {
+public:
+
+    PooledSuite(std::size_t numberOfScenarios) {
+        for (std::size_t scenario = 0; scenario < numberOfScenarios; ++scenario)
+            CreateScenario< PooledScenario<ContextType> >("Pooled " + std::to_string(scenario));
+    }
+};
+
+class ContextPool : public SelfTestStep {
+public:
+
+    ContextPool()
+    : SelfTestStep("Context pool", "Contexts with Reset() are reset and reused; those failing to reset are replaced") {
+    }
+
+    void Verify() override {
+        ACC_TEST_CHECK(static_cast<bool> (AccTestHasReset<PooledContext>::value));
+        ACC_TEST_CHECK(!AccTestHasReset<SelfTestContext>::value);
+        pooledContextsConstructed = pooledContextsReset = 0;
+        ACC_TEST_CHECK_EQUAL(Run<PooledContext>(5), 5u);
+        // The pool keeps the context until the program exits, so a repeated run of this test constructs none.
+        ACC_TEST_CHECK(pooledContextsConstructed.load() <= 1);
+        ACC_TEST_CHECK_EQUAL(pooledContextsReset.load(), 5);
+        pooledContextsConstructed = pooledContextsReset = 0;
+        ACC_TEST_CHECK_EQUAL(Run<UnresettableContext>(5), 5u);
+        ACC_TEST_CHECK_EQUAL(pooledContextsConstructed.load(), 5);
+        ACC_TEST_CHECK_EQUAL(pooledContextsReset.load(), 0);
+    }
+
+private:
+
+    // Returns the number of scenarios passed.
+    template <class ContextType>
+    static std::size_t Run(std::size_t numberOfScenarios) {
+        std::ostringstream report;
+        auto textObserver = std::make_shared<AccTestObserver>(report);
+        PooledSuite<ContextType> suite(numberOfScenarios);
+        suite.SetTestObserver(textObserver);
+        suite.Run();
+        return textObserver->GetSummary().GetNumberOfScenariosPassed();
+    }
+};
+
+#ifdef ACC_TEST_POSIX
+
+// A scenario that passes, one that crashes, and one that never finishes.
+class IsolatedStep : public AccTestStep<LoggedContext> {
+public:
+
+    enum Behavior {
+        Passes, Crashes, Hangs
+    };
+
+    IsolatedStep(Behavior behavior)
+    : AccTestStep<LoggedContext>("Isolated step", "Passes, crashes, or hangs"), m_Behavior(behavior) {
+    }
+
+    void Verify() override {
+        if (m_Behavior == Crashes)
+            std::abort();
+        if (m_Behavior == Hangs)
+            std::this_thread::sleep_for(std::chrono::seconds(60));
+        ACC_TEST_CHECK(m_Behavior == Passes);
+    }
+
+private:
+    Behavior m_Behavior;
+};
+
+class IsolatedScenario : public AccTestScenario<LoggedContext> {
+public:
+
+    IsolatedScenario(const std::string& name, IsolatedStep::Behavior behavior)
+    : AccTestScenario<LoggedContext>(name, "An isolated scenario") {
+        CreateStep<IsolatedStep>(behavior);
+    }
+};
+
+class IsolatedSuite : public AccTestSuite {
+public:
+
+    IsolatedSuite() {
+        CreateScenario<IsolatedScenario>("Crashing", IsolatedStep::Crashes);
+        CreateScenario<IsolatedScenario>("Hanging", IsolatedStep::Hangs);
+        CreateScenario<IsolatedScenario>("Passing", IsolatedStep::Passes);
+    }
+};
+
+class ProcessIsolation : public SelfTestStep {
+public:
+
+    ProcessIsolation()
+    : SelfTestStep("Process isolation", "Crashing and hanging scenarios are terminated and the others still run") {
+    }
+
+    void Verify() override {
+        std::ostringstream report;
+        auto textObserver = std::make_shared<AccTestObserver>(report);
+        auto verdicts = std::make_shared<AccTestVerdictObserver>();
+        auto observers = std::make_shared<AccTestObserverGroup>();
+        observers->Add(textObserver);
+        observers->Add(verdicts);
+        IsolatedSuite suite;
+        AccTestSuiteOptions options;
+        options.NumberOfJobs = 2;
+        options.IsolateScenarios = true;
+        options.ScenarioTimeout = std::chrono::duration_cast<AccTestClock::duration>(std::chrono::seconds(1));
+        suite.SetOptions(options);
+        suite.SetTestObserver(observers);
+        auto start = AccTestClock::now();
+        {
+            std::lock_guard<std::mutex> lock(forkingTestMutex);
+            suite.Run();
+        }
+        ACC_TEST_CHECK(AccTestClock::now() - start < std::chrono::seconds(30));
+        auto summary = textObserver->GetSummary();
+        auto text = report.str();
+        ACC_TEST_CHECK_EQUAL(summary.NumberOfScenarios, 3u);
+        ACC_TEST_CHECK_EQUAL(summary.NumberOfScenariosTerminated, 2u);
+        ACC_TEST_CHECK_EQUAL(summary.NumberOfScenariosFailed, 0u);
+        ACC_TEST_CHECK_EQUAL(summary.GetNumberOfScenariosPassed(), 1u);
+        ACC_TEST_CHECK_EQUAL(verdicts->GetScenarioVerdicts().size(), 3u);
+        bool onlyPassingPassed = true;
+        for (const auto& verdict : verdicts->GetScenarioVerdicts())
+            onlyPassingPassed = onlyPassingPassed && verdict.second == (verdict.first == "Passing");
+        ACC_TEST_CHECK(onlyPassingPassed);
+        ACC_TEST_CHECK(text.find("The process running the scenario was killed by signal " + std::to_string(SIGABRT)) != 
+                std::string::npos) << text;
+        ACC_TEST_CHECK(text.find("The process running the scenario exceeded the time limit of 1 s; terminated!") != 
+                std::string::npos) << text;
+    }
+};
+
+// Counts up to NumberOfSteps, one step at a time, with a checkpoint after the first step. The context is only right for
+// the second step if the first one ran or the checkpoint was loaded.
+struct CheckpointContext {
+    int Value = 0;
+};
+
+class CountingStep : public AccTestStep<CheckpointContext> {
+public:
+
+    CountingStep(int number, int* runs)
+    : AccTestStep<CheckpointContext>("Step " + std::to_string(number), "Counts"), m_Number(number), m_Runs(runs) {
+    }
+
+    void Act() override {
+        ++*m_Runs;
+        ++GetTestContext()->Value;
+    }
+
+    void Verify() override {
+        ACC_TEST_CHECK_EQUAL(GetTestContext()->Value, m_Number);
+    }
+
+private:
+    int m_Number;
+    int* m_Runs;
+};
+
+class CheckpointedScenario : public AccTestScenario<CheckpointContext> {
+public:
+
+    CheckpointedScenario(int numberOfSteps, int* runs)
+    : AccTestScenario<CheckpointContext>("Checkpointed", "Counts") {
+        CreateStep<CountingStep>(1, runs);
+        CreateCheckpoint();
+        for (int number = 2; number <= numberOfSteps; ++number)
+            CreateStep<CountingStep>(number, runs);
+    }
+
+protected:
+
+    bool SaveContext(std::ostream& output) override {
+        return static_cast<bool> (output << GetTestContext()->Value);
+    }
+
+    bool LoadContext(std::istream& input) override {
+        return static_cast<bool> (input >> GetTestContext()->Value);
+    }
+};
+
+class CheckpointedSuite : public AccTestSuite {
+public:
+
+    CheckpointedSuite(int numberOfSteps, int* runs) {
+        CreateScenario<CheckpointedScenario>(numberOfSteps, runs);
+    }
+};
+
+class CheckpointResume : public SelfTestStep {
+public:
+
+    CheckpointResume()
+    : SelfTestStep("Checkpoint resume", "Resuming skips the steps before the checkpoint unless the steps have changed") {
+    }
+
+    void Verify() override {
+        TemporaryDirectory directory;
+        ACC_TEST_CHECK(!directory.GetPath().empty());
+        std::string report;
+        ACC_TEST_CHECK_EQUAL(Run(directory.GetPath(), 0, 2, report), 2);
+        ACC_TEST_CHECK(report.find("Resuming") == std::string::npos) << report;
+        ACC_TEST_CHECK_EQUAL(Run(directory.GetPath(), AccTestCheckpointOptions::ResumeFromLatest, 2, report), 1);
+        ACC_TEST_CHECK(report.find("Resuming from the checkpoint after step 1;") != std::string::npos) << report;
+        ACC_TEST_CHECK_EQUAL(Run(directory.GetPath(), 1, 2, report), 2);
+        ACC_TEST_CHECK(report.find("Resuming") == std::string::npos) << report;
+        ACC_TEST_CHECK_EQUAL(Run(directory.GetPath(), AccTestCheckpointOptions::ResumeFromLatest, 3, report), 3);
+        ACC_TEST_CHECK(report.find("Resuming") == std::string::npos) << report;
+    }
+
+private:
+
+    // Returns the number of steps run, or -1 if the scenario failed.
+    static int Run(const std::string& directory, std::size_t resumeFromStep, int numberOfSteps, std::string& report) {
+        std::ostringstream output;
+        auto textObserver = std::make_shared<AccTestObserver>(output);
+        int runs = 0;
+        CheckpointedSuite suite(numberOfSteps, &runs);
+        AccTestSuiteOptions options;
+        options.Checkpoints.Directory = directory;
+        options.Checkpoints.ResumeFromStep = resumeFromStep;
+        options.Checkpoints.ProgramFingerprint = "build";
+        suite.SetOptions(options);
+        suite.SetTestObserver(textObserver);
+        suite.Run();
+        report = output.str();
+        return textObserver->GetSummary().GetNumberOfScenariosPassed() == 1 ? runs : -1;
+    }
+};
+
+// Scenarios counting their runs by name: two that pass, one of them with a description given to the suite, one that fails,
+// and two passing ones sharing a name.
+typedef std::map<std::string, int> RunCounts;
+
+class CountedStep : public AccTestStep<SelfTestContext> {
+public:
+
+    CountedStep(const std::string& scenarioName, bool passes, RunCounts* runs)
+    : AccTestStep<SelfTestContext>("Counted step", "Counts the runs of its scenario"), m_ScenarioName(scenarioName),
+    m_Passes(passes), m_Runs(runs) {
+    }
+
+    void Verify() override {
+        ++(*m_Runs)[m_ScenarioName];
+        ACC_TEST_CHECK(m_Passes);
+    }
+
+private:
+    std::string m_ScenarioName;
+    bool m_Passes;
+    RunCounts* m_Runs;
+};
+
+class CountedScenario : public AccTestScenario<SelfTestContext> {
+public:
+
+    CountedScenario(const std::string& name, const std::string& description, bool passes, RunCounts* runs)
+    : AccTestScenario<SelfTestContext>(name, description) {
+        CreateStep<CountedStep>(name, passes, runs);
+    }
+};
+
+class CachedSuite : public AccTestSuite {
+public:
+
+    CachedSuite(const std::string& description, RunCounts* runs) {
+        CreateScenario<CountedScenario>("Stable", "Never changes", true, runs);
+        CreateScenario<CountedScenario>("Described", description, true, runs);
+        CreateScenario<CountedScenario>("Failing", "Never passes", false, runs);
+        CreateScenario<CountedScenario>("Twin", "One of two", true, runs);
+        CreateScenario<CountedScenario>("Twin", "The other one", true, runs);
+    }
+};
+
+class ResultCache : public SelfTestStep {
+public:
+
+    ResultCache()
+    : SelfTestStep("Result cache", "Passed scenarios aren't run again until their description or steps change") {
+    }
+
+    void Verify() override {
+        TemporaryDirectory directory;
+        ACC_TEST_CHECK(!directory.GetPath().empty());
+        auto file = directory.GetPath() + "/results";
+        AccTestSummary summary;
+        ACC_TEST_CHECK_EQUAL(Run(file, "first", false, summary), 
+                RunCounts({{"Described", 1}, {"Failing", 1}, {"Stable", 1}, {"Twin", 2}}));
+        ACC_TEST_CHECK_EQUAL(summary.NumberOfScenariosCached, 0u);
+        ACC_TEST_CHECK_EQUAL(Run(file, "first", false, summary), RunCounts({{"Failing", 1}, {"Twin", 2}}));
+        ACC_TEST_CHECK_EQUAL(summary.NumberOfScenariosCached, 2u);
+        ACC_TEST_CHECK_EQUAL(summary.NumberOfScenarios, 5u);
+        ACC_TEST_CHECK_EQUAL(summary.NumberOfScenariosFailed, 1u);
+        ACC_TEST_CHECK_EQUAL(Run(file, "second", false, summary), RunCounts({{"Described", 1}, {"Failing", 1}, {"Twin", 2}}));
+        ACC_TEST_CHECK_EQUAL(summary.NumberOfScenariosCached, 1u);
+        ACC_TEST_CHECK_EQUAL(Run(file, "second", true, summary), 
+                RunCounts({{"Described", 1}, {"Failing", 1}, {"Stable", 1}, {"Twin", 2}}));
+        ACC_TEST_CHECK_EQUAL(summary.NumberOfScenariosCached, 0u);
+    }
+
+private:
+
+    static RunCounts Run(const std::string& file, const std::string& description, bool forceRun, AccTestSummary& summary) {
+        std::ostringstream report;
+        auto textObserver = std::make_shared<AccTestObserver>(report);
+        RunCounts runs;
+        CachedSuite suite(description, &runs);
+        AccTestSuiteOptions options;
+        options.ResultCacheFile = file;
+        options.ResultCacheFingerprint = "build";
+        options.ForceRun = forceRun;
+        suite.SetOptions(options);
+        suite.SetTestObserver(textObserver);
+        suite.Run();
+        summary = textObserver->GetSummary();
+        return runs;
+    }
+};
+
+class CheckpointFingerprint : public SelfTestStep {
+public:
+
+    CheckpointFingerprint()
+    : SelfTestStep("Checkpoint fingerprint", "Checkpoints are only loaded by the build of the program that saved them") {
+    }
+
+    void Verify() override {
+        TemporaryDirectory directory;
+        ACC_TEST_CHECK(!directory.GetPath().empty());
+        std::string context;
+        AccTestCheckpointStore saved(directory.GetPath(), "Scenario", "steps", "build 1");
+        ACC_TEST_CHECK(saved.Save(2, "context"));
+        ACC_TEST_CHECK(AccTestCheckpointStore(directory.GetPath(), "Scenario", "steps", "build 1").Load(2, context));
+        ACC_TEST_CHECK_EQUAL(context, "context");
+        ACC_TEST_CHECK(!AccTestCheckpointStore(directory.GetPath(), "Scenario", "steps", "build 2").Load(2, context));
+        ACC_TEST_CHECK(!AccTestCheckpointStore(directory.GetPath(), "Scenario", "steps").Load(2, context));
+        ACC_TEST_CHECK(!AccTestCheckpointStore(directory.GetPath(), "Scenario", "other steps", "build 1").Load(2, context));
+    }
+};
+
+#endif
+
+class SelfTestSuite : public AccTestSuite {
+public:
+
+    SelfTestSuite() {
+        CreateTest<LongOptions>("Command line: long options", "command-line");
+        CreateTest<ShortOptions>("Command line: short options", "command-line");
+        CreateTest<UnknownAndInvalidArguments>("Command line: unknown and invalid arguments", "command-line");
+        CreateTest<RunnerOptions>("Command line: runner options", "command-line");
+        CreateTest<GlobFilters>("Name filter: globs", "name-filter");
+        CreateTest<RegexFilters>("Name filter: regular expressions", "name-filter");
+        CreateTest<BinaryLogRoundTrip>("Binary log: round trip", "binary-log");
+        CreateTest<StepTimingOutput>("Report: step timing output", "report");
+        CreateTest<QueueOrdering>("Async observer: queue ordering", "async-observer");
+        CreateTest<AsyncObserverBlocking>("Async observer: blocking", "async-observer");
+        CreateTest<AsyncObserverDropping>("Async observer: dropping scenarios", "async-observer");
+        CreateTest<WorkerPoolTasks>("Worker pool: tasks", "worker-pool");
+        CreateTest<ParallelSuite>("Worker pool: parallel suite", "worker-pool");
+        CreateTest<Branches>("Branches: common steps and context copies", "branches");
+        CreateTest<SharedFixtures>("Fixtures: shared fixture lifetimes", "fixtures");
+        CreateTest<ContextPool>("Contexts: pooled contexts", "contexts");
+        CreateTest<BenchmarkStatistics>("Statistics: benchmark results", "statistics");
+        CreateTest<BaselineComparison>("Statistics: baseline comparison", "statistics");
+#ifdef ACC_TEST_POSIX
+        CreateTest<ProcessIsolation>("Process isolation: crashes and timeouts", "isolation");
+        CreateTest<CheckpointResume>("Checkpoints: resume and invalidation", "checkpoints");
+        CreateTest<CheckpointFingerprint>("Checkpoints: program fingerprint", "checkpoints");
+        CreateTest<ResultCache>("Result cache: cached and rerun scenarios", "result-cache");
+#endif
+    }
+
+private:
+
+    template <class StepType>
+    void CreateTest(const std::string& name, const std::string& tag) {
+        AccTestScenarioInfo info;
+        info.Name = name;
+        info.Tags = {tag};
+        CreateScenario< SelfTestScenario<StepType> >(info, name);
+    }
+};
+
+ACC_TEST_DEFAULT_MAIN_FUNC(SelfTestSuite)
@@ -0,0 +1,66 @@
+//    MIT License
+//
+//    Copyright (c) 2017 Muhammad Ismail Soboute
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy
+//    of this software and associated documentation files (the "Software"), to deal
+//    in the Software without restriction, including without limitation the rights
+//    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//    copies of the Software, and to permit persons to whom the Software is
+//    furnished to do so, subject to the following conditions:
+//
+//    The above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//    SOFTWARE.
+
+// Keeps a test suite built as a shared library with ACC_TEST_EXPORT_SUITE loaded and runs it on command (see 
+// AccTestSuiteHost in AccTest.h for the commands). Build it on its own, e.g. 
+// "g++ -std=c++11 -pthread AccTestSuiteHost.cpp -o AccTestSuiteHost -ldl", and run it as
+//   AccTestSuiteHost LIBRARY                 read commands from the standard input
+//   AccTestSuiteHost LIBRARY --socket=PATH   take commands from clients of a Unix socket created at PATH, e.g.
+//                                            echo "run -f Login*" | nc -U PATH
+// The library must be built with the same version of AccTest.h.
+
+#include <iostream>
+#include <string>
+
+#include "AccTest.h"
+
+using namespace ProTest;
+
+int main(int argc, char** argv) {
+    std::string library, socketPath;
+    for (int index = 1; index < argc; ++index) {
+        std::string argument = argv[index];
+        if (argument.compare(0, 9, "--socket=") == 0)
+            socketPath = argument.substr(9);
+        else if (library.empty() && argument.compare(0, 2, "--") != 0)
+            library = argument;
+        else {
+            std::cerr << "Unknown command line argument: " << argument << std::endl;
+            return -1;
+        }
+    }
+    if (library.empty()) {
+        std::cerr << "Usage: " << argv[0] << " LIBRARY [--socket=PATH]" << std::endl;
+        return -1;
+    }
+    try {
+        AccTestSuiteHost host(library);
+        if (socketPath.empty())
+            host.Serve(std::cin, std::cout);
+        else
+            host.ServeSocket(socketPath);
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -149,10 +149,18 @@ private:
 // The test context is required to hold state of the application, test stubs, and other test related data. It is initialized
 // within the test scenario Setup, used and affected by each step, passed on to the next step, and the disposed within the test
 // test scenario Teardown.
+// This one owns the fake UI and has a Reset() method, so the scenarios take their contexts from a pool: a finished scenario
+// gives its context back, and Reset() puts the fake back into its initial state for the next scenario instead of it being 
+// allocated all over again.
 
 struct CalcTestContext {
-    FakeCaclUserInterface* UI;
+    std::unique_ptr<FakeCaclUserInterface> UI{new FakeCaclUserInterface()};
     std::shared_ptr<MyCalcApplication> App;
+
+    void Reset() {
+        App.reset();
+        *UI = FakeCaclUserInterface();
+    }
 };
 
 // Each step of the test scenario inherits AccTestStep<T> where T is the type serving as our text context.
@@ -169,12 +177,12 @@ public:
 
     void Act() override {
         auto ctx = GetTestContext();
-        ctx->App = std::make_shared<MyCalcApplication>(ctx->UI);
+        ctx->App = std::make_shared<MyCalcApplication>(ctx->UI.get());
         ctx->App->StartUp();
     }
 
     void Verify() override {
-        auto ui = GetTestContext()->UI;
+        auto ui = GetTestContext()->UI.get();
         ACC_TEST_CHECK_EQUAL(ui->m_TitleBar, "My Calculator");
         ACC_TEST_CHECK_EQUAL(ui->m_StatusBar, "Ready");
         ACC_TEST_CHECK_EQUAL(ui->m_ResultContents, "0");
@@ -194,13 +202,13 @@ public:
     }
 
     void Act() override {
-        auto ui = GetTestContext()->UI;
+        auto ui = GetTestContext()->UI.get();
         ui->m_TextBoxContents = m_Input;
         ui->m_AddButtonCallBack();
     }
 
     void Verify() override {
-        auto ui = GetTestContext()->UI;
+        auto ui = GetTestContext()->UI.get();
         ACC_TEST_CHECK_EQUAL(ui->m_StatusBar, m_Status);
         ACC_TEST_CHECK_EQUAL(ui->m_ResultContents, m_Result);
     }
@@ -229,13 +237,13 @@ public:
     }
 
     void Act() override {
-        auto ui = GetTestContext()->UI;
+        auto ui = GetTestContext()->UI.get();
         ui->m_TextBoxContents = m_Input;
         ui->m_SubtractButtonCallBack();
     }
 
     void Verify() override {
-        auto ui = GetTestContext()->UI;
+        auto ui = GetTestContext()->UI.get();
         bool success = ui->m_StatusBar == m_Status && ui->m_ResultContents == m_Result;
         ACC_TEST_CHECK_EQUAL(ui->m_StatusBar, m_Status);
         ACC_TEST_CHECK_EQUAL(ui->m_ResultContents, m_Result);
@@ -262,7 +270,7 @@ public:
     }
 
     void Expect() override {
-        auto ui = GetTestContext()->UI;
+        auto ui = GetTestContext()->UI.get();
         ui->ExpectClose(1);
     }
 
@@ -272,7 +280,7 @@ public:
     }
 
     void Verify() override {
-        auto ui = GetTestContext()->UI;
+        auto ui = GetTestContext()->UI.get();
         Check(ui->VerifyExpectedClose()) << "Close not called on the GUI!";
     }
 };
@@ -280,7 +288,8 @@ public:
 // Each test scenario, which is usually composed of many steps, must inherit AccTestScenario. During construction, it must add 
 // its respective test steps using AddStep in the same order which they must be run. The test scenario creates the context for you,
 // but you need to create the application object and other test stubs. This can be done by overriding Setup(). Make sure to perform
-// any clean-ups required within Teardown() by overriding it.
+// any clean-ups required within Teardown() by overriding it. Our context creates the fake UI itself, and the first step creates 
+// the application, so there is nothing left to do in Setup() and Teardown().
 
 class MyTestScenario : public AccTestScenario<CalcTestContext> {
 public:
@@ -318,17 +327,6 @@ public:
                 "14_Input20_Add_Result45_Status_Ready", "20", "Ready", "45");
         CreateStep<TestStepExitingAppMustCloseTheUI>("15_ExitApp_UIMustBeClosed");
     }
-
-    void Setup() override {
-        auto ctx = GetTestContext();
-        ctx->UI = new FakeCaclUserInterface();
-    }
-
-    void Teardown() override {
-        auto ctx = GetTestContext();
-        delete ctx->UI;
-    }
-
 };
 
 // Each test executable must have exactly one test suite. Ours has only one scenario (start to finish).